@@ -4,82 +4,196 @@
 #include <iostream>
 #include <ctime>
 #include <sstream>
-#include <chrono>
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 
 /* By standard, const floats cannot be defined in the header file, so it is done here. */
 static const float s_kfSHOOT_COOLDOWN = 0.5;
 
+/* The IDs passed to alarmComplete(), in the same order as the Alarms enum. */
+static const char* s_kasALARM_IDS[] = {"ShotFired", "IntroStageDuration", "IntervalStageDuration", "CometStageDuration",
+									   "SaucerStageDuration", "ReviveImmunity", "SpawnComet", "SpawnSaucer", "BossVulnerability",
+									   "BossAttack", "BossDeath"};
+
+/* The GameObject type names, in the same order as the ObjectTypes enum. */
+static const char* s_kasOBJECT_TYPES[] = {"ship", "boss", "comet", "saucer", "bullet", "bossbullet"};
+
+/* Constructor */
+ArcadeGame::ArcadeGame(sf::RenderWindow& rw, sf::Uint64 iSeed, int iNumWorkers):BaseArcade(rw), m_Random(iSeed),
+	m_Background(SCREEN_WIDTH, SCREEN_HEIGHT), m_pOwnAssets(new Assets()), m_pAssets(m_pOwnAssets.get()), m_Jobs(iNumWorkers), m_WindowRenderer(rw)
+{
+	m_pOwnAssets->load();
+	initialise();
+}
+
+/* Constructor */
+ArcadeGame::ArcadeGame(sf::RenderWindow& rw, sf::Uint64 iSeed, const Assets& assets, int iNumWorkers):BaseArcade(rw), m_Random(iSeed),
+	m_Background(SCREEN_WIDTH, SCREEN_HEIGHT), m_pAssets(&assets), m_Jobs(iNumWorkers), m_WindowRenderer(rw)
+{
+	initialise();
+}
+
+/* Destructor */
+ArcadeGame::~ArcadeGame()
+{
+}
+
+const ArcadeGame::Assets& ArcadeGame::getAssets() const
+{
+	return *m_pAssets;
+}
+
 /* Constructor */
-ArcadeGame::ArcadeGame(sf::RenderWindow& rw):BaseArcade(rw)
+ArcadeGame::Assets::Assets()
+{
+	bHasBackground = false;
+}
+
+/* Loads a texture with its black pixels made transparent, as BaseArcade::loadTexture() does. Without this the */
+/* window draws the black around a sprite with no alpha channel of its own, e.g. the comet, as a solid box. */
+static bool loadMaskedTexture(sf::Texture& texture, const std::string& sPath)
+{
+	sf::Image image;
+	if (!image.loadFromFile(sPath))
+	{
+		return false;
+	}
+	image.createMaskFromColor(sf::Color::Black);
+	return texture.loadFromImage(image);
+}
+
+/* Loads the ship and each frame of the boss into textures of their own. GameObjects take their size from their */
+/* texture, so frames cannot share one. Every font size the game uses is declared here so that all glyphs are */
+/* rasterized while loading. Nothing is changed afterwards, which keeps the assets safe to read from any thread. */
+bool ArcadeGame::Assets::load()
+{
+	bool bLoaded = aObjectTextures[OBJECT_SHIP].loadFromFile("images/ship.png", sf::IntRect(0, 0, 79, 30));
+	for (int i = 0; i < s_kiNUM_BOSS_FRAMES; i++)
+	{
+		bLoaded &= aBossTextures[i].loadFromFile("images/boss.png", sf::IntRect(i * s_kiBOSS_FRAME_WIDTH, 0, s_kiBOSS_FRAME_WIDTH, 600));
+	}
+	for (int i = OBJECT_COMET; i < NUM_OBJECT_TYPES; i++)
+	{
+		bLoaded &= loadMaskedTexture(aObjectTextures[i], string("images/") + s_kasOBJECT_TYPES[i] + ".png");
+	}
+
+	/* A background too wide for one texture is left for each game to stream itself. */
+	bHasBackground = background.loadFromFile("images/starfield1.png");
+	background.setRepeated(true);
+
+	std::vector<unsigned int> vFontSizes;
+	vFontSizes.push_back(s_kiTITLE_FONT_SIZE);
+	vFontSizes.push_back(s_kiSCOREBOARD_FONT_SIZE);
+	bLoaded &= font.build("images/arial.ttf", vFontSizes);
+	return bLoaded;
+}
+
+/* Sets up everything but the assets, for both constructors. GameObjects take a texture that is not const, but */
+/* never change it, so the pointers into the assets are only ever read through. */
+void ArcadeGame::initialise()
 {
 	registerListener(this);
 
-	setBackground("images/starfield1.png", 100);
+	m_pRenderer = &m_WindowRenderer;
+	m_pShip = NULL;
+	m_iTick = 0;
+	m_iGameStartTick = 0;
+	m_RunAheadCost.iSaveTime = 0;
+	m_RunAheadCost.iSimulateTime = 0;
+	m_RunAheadCost.iRestoreTime = 0;
+	m_LoadLevel = FrameGovernor::FULL_QUALITY;
+	m_iFramesSinceTextLayout = 0;
+	m_iSceneGeneration = 0;
+	m_bHasRestartSnapshot = false;
+	m_bFixedPoint = false;
+	m_iRestartTime = 0;
+	m_Commands.setNumThreads(m_Jobs.getNumThreads());
+	cancelAllAlarms();
+
+	if (m_pAssets->bHasBackground)
+	{
+		m_Background.addLayer(m_pAssets->background, s_kiBACKGROUND_SCROLL_SPEED);
+	}
+	else
+	{
+		m_Background.addLayer("images/starfield1.png", s_kiBACKGROUND_SCROLL_SPEED);
+	}
 
-	srand(time(NULL));
+	for (int i = 0; i < s_kiNUM_BOSS_FRAMES; i++)
+	{
+		m_apBossTextures[i] = const_cast<sf::Texture*>(&m_pAssets->aBossTextures[i]);
+	}
+	for (int i = 0; i < NUM_OBJECT_TYPES; i++)
+	{
+		m_apObjectTextures[i] = const_cast<sf::Texture*>(&m_pAssets->aObjectTextures[i]);
+	}
+	m_apObjectTextures[OBJECT_BOSS] = m_apBossTextures[1];
+	for (int i = 0; i < NUM_OBJECT_TYPES; i++)
+	{
+		m_vPrototypes.push_back(GameObject(m_apObjectTextures[i], s_kasOBJECT_TYPES[i]));
+	}
 
-	loadTexture("images/ship.png", "shiptexture");
-	loadTexture("images/comet.png", "comettexture");
-	loadTexture("images/saucer.png", "saucertexture");
-	loadTexture("images/bullet.png", "bullettexture");
-	loadTexture("images/boss.png", "bosstexture");
-	loadTexture("images/bossbullet.png", "bossbullettexture");
+	m_HealthCounter = m_Hud.createCounter(m_apObjectTextures[OBJECT_SHIP], sf::IntRect(0, 0, 79, 30), 38, 35, 73);
 
 	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
 	{
 		m_aiScores[i] = 0;
 	}
+
+	createText();
 	
 	restartGame();
 }
 
-/* Returns the elapsed time since the start of the program. */
+/* Returns the time the game has been running, in seconds. It is counted in ticks rather than read from a clock */
+/* shared by the whole program, so that games run side by side each keep their own time. */
 float ArcadeGame::getElapsedTime()
 {
-	using namespace std::chrono;
-	static high_resolution_clock::time_point start = high_resolution_clock::now();
-
-	return duration_cast<duration<float>>(start - high_resolution_clock::now()).count();
+	return static_cast<float>(m_iTick) / s_kiTICKS_PER_SECOND;
 }
 
 /* The main function. Cycled every "tick". */
 /* Player input and game actions that should be repeated whilst in a particular state should (usually) go in here. */
-void ArcadeGame::gameMain(std::string sKeyPressed)
+void ArcadeGame::gameMain(const InputState& input)
 {
 	/* Check movement outside of Gamestate because it is almost always relevant. */
 	if (m_pShip)
 	{
-		if (sKeyPressed.compare("RIGHT") == 0)
+		/* The ship moves while a key is held and stops when it is let go. An axis the player cannot move along */
+		/* in this stage is left alone, as the stage may be steering the ship along it. Keys held for only part */
+		/* of the last tick move the ship that much less, so its movement follows the exact times keys went */
+		/* down and up rather than the tick they were seen in. */
+		sf::Vector2f direction = m_pShip->getVelocity();
+		if (m_bCanMoveLeft || m_bCanMoveRight)
 		{
+			direction.x = 0;
 			if (m_bCanMoveRight)
-			{
-				m_pShip->setVelocity(1, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
-			}
+				direction.x += input.getHeldFraction(InputState::KEY_RIGHT);
+			if (m_bCanMoveLeft)
+				direction.x -= input.getHeldFraction(InputState::KEY_LEFT);
 		}
-		else if (sKeyPressed.compare("LEFT") == 0)
+		else
 		{
-			if (m_bCanMoveLeft)
-			{
-				m_pShip->setVelocity(-1, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
-			}
+			direction.x = getSign(direction.x);
 		}
-		else if (sKeyPressed.compare("UP") == 0)
+		if (m_bCanMoveUp || m_bCanMoveDown)
 		{
+			direction.y = 0;
+			if (m_bCanMoveDown)
+				direction.y += input.getHeldFraction(InputState::KEY_DOWN);
 			if (m_bCanMoveUp)
-			{
-				m_pShip->setVelocity(m_pShip->getVelocity().x, -1, s_kiOBJECT_DEFAULT_SPEED);
-			}
+				direction.y -= input.getHeldFraction(InputState::KEY_UP);
 		}
-		else if (sKeyPressed.compare("DOWN") == 0)
+		else
 		{
-			if (m_bCanMoveDown)
-			{
-				m_pShip->setVelocity(m_pShip->getVelocity().x, 1, s_kiOBJECT_DEFAULT_SPEED);
-			}	
+			direction.y = getSign(direction.y);
 		}
-		else if (sKeyPressed.compare("SPACE") == 0)
+		float fSpeedFraction = std::max(fabs(direction.x), fabs(direction.y));
+		m_pShip->setVelocity(direction.x, direction.y, s_kiOBJECT_DEFAULT_SPEED * fSpeedFraction);
+
+		if (input.wasPressed(InputState::KEY_SPACE))
 		{
 			if (m_bCanShoot)
 			{
@@ -93,8 +207,6 @@ void ArcadeGame::gameMain(std::string sKeyPressed)
 	/* Gamestate management. */
 	if (m_GameState == GameState::INTRODUCTION)
 	{
-		setFontSize(50);
-		createMessage(("S C R A M B L E"), 230, 100);
 	}
 	else if (m_GameState == GameState::INTERVAL)
 	{
@@ -106,37 +218,40 @@ void ArcadeGame::gameMain(std::string sKeyPressed)
 		{
 			if (!alarmIsActive(ArcadeGame::Alarms::SPAWN_COMET))
 			{
-				createAlarm(ArcadeGame::Alarms::SPAWN_COMET, 0.8);
+				createAlarm(ArcadeGame::Alarms::SPAWN_COMET, 0.8f * getSpawnIntervalScale());
 			}
 		}
 	}
 	else if (m_GameState == GameState::SAUCER)
 	{
-		/* Auto-correct position. */
-		if (!isBetween(290, 310, m_pShip->getPosition().y))
+		if (m_pShip)
 		{
-			if (m_pShip->getPosition().y > 310 )
+			/* Auto-correct position. */
+			if (!isBetween(290, 310, m_pShip->getPosition().y))
 			{
-				m_pShip->setVelocity(m_pShip->getVelocity().x, -1, s_kiOBJECT_DEFAULT_SPEED);
+				if (m_pShip->getPosition().y > 310 )
+				{
+					m_pShip->setVelocity(m_pShip->getVelocity().x, -1, s_kiOBJECT_DEFAULT_SPEED);
+				}
+				else if (m_pShip->getPosition().y < 290)
+				{
+					m_pShip->setVelocity(m_pShip->getVelocity().x, 1, s_kiOBJECT_DEFAULT_SPEED);
+				}
 			}
-			else if (m_pShip->getPosition().y < 290)
-			{
-				m_pShip->setVelocity(m_pShip->getVelocity().x, 1, s_kiOBJECT_DEFAULT_SPEED);
+
+			/* Stop auto-correct when position is valid. */
+			if (isBetween(290, 310, m_pShip->getPosition().y) && m_pShip->getVelocity().y != 0)
+			{	
+				m_pShip->setVelocity(m_pShip->getVelocity().x, 0, s_kiOBJECT_DEFAULT_SPEED);
 			}
 		}
 
-		/* Stop auto-correct when position is valid. */
-		if (isBetween(290, 310, m_pShip->getPosition().y) && m_pShip->getVelocity().y != 0)
-		{	
-			m_pShip->setVelocity(m_pShip->getVelocity().x, 0, s_kiOBJECT_DEFAULT_SPEED);
-		}
-		
 		/* Spawns Saucers in groups of 4 (If able). */
 		if (m_iNumSaucers < (s_kiMAX_SAUCERS - 3))
 		{
 			if (!alarmIsActive(ArcadeGame::Alarms::SPAWN_SAUCER))
 			{
-				createAlarm(ArcadeGame::Alarms::SPAWN_SAUCER, 4.25);
+				createAlarm(ArcadeGame::Alarms::SPAWN_SAUCER, 4.25f * getSpawnIntervalScale());
 			}
 		}
 		
@@ -146,60 +261,259 @@ void ArcadeGame::gameMain(std::string sKeyPressed)
 			if(getGameObject(i)->getObjectType() == "saucer")
 			{
 				sf::Vector2f position = getGameObject(i)->getPosition();
-				position.y = (sin((1300 - position.x) / 100) * 200) + 300;
+				if (m_bFixedPoint)
+				{
+					sf::Int32 iAngle = (FixedPoint::fromInt(1300) - FixedPoint::fromFloat(position.x)) / 100;
+					position.y = FixedPoint::toFloat(FixedPoint::sine(iAngle) * 200 + FixedPoint::fromInt(300));
+				}
+				else
+				{
+					position.y = (sin((1300 - position.x) / 100) * 200) + 300;
+				}
 				getGameObject(i)->setPosition(position);
 			}
 		}
 	}
 	else if (m_GameState == GameState::BOSS)
 	{
-		/* Auto-correct position. */
-		if (!isBetween(40, 90, m_pShip->getPosition().x))
+		if (m_pShip)
 		{
-			if (m_pShip->getPosition().x > 90)
+			/* Auto-correct position. */
+			if (!isBetween(40, 90, m_pShip->getPosition().x))
 			{
-				m_pShip->setVelocity(-1, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
+				if (m_pShip->getPosition().x > 90)
+				{
+					m_pShip->setVelocity(-1, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
+				}
+				else if (m_pShip->getPosition().x < 40)
+				{
+					m_pShip->setVelocity(1, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
+				}
 			}
-			else if (m_pShip->getPosition().x < 40)
+
+			/* Stop auto-correct when position is valid. */
+			if (isBetween(40, 90, m_pShip->getPosition().x) && m_pShip->getVelocity().x != 0)
 			{
-				m_pShip->setVelocity(1, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
+				m_pShip->setVelocity(0, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
 			}
 		}
+	}
+	else if (m_GameState == GameState::SCOREBOARD)
+	{
+		if (input.wasPressed(InputState::KEY_R))
+		{
+			restartGame();
+		}
+	}
+
+	/* The world is updated last, after the stage logic above has reacted to the input. The tick count advances */
+	/* just before it, so that anything the update sets off (e.g. endGame() scoring the time played) sees the */
+	/* tick being run. */
+	/* Every tick is the same length, however long it really took, so the game depends only on its input. */
+	m_iTick++;
+	updateWorld(1.0f / s_kiTICKS_PER_SECOND);
+}
+
+/* Does the work BaseArcade::gameMain() used to do, on the game side so that it can be spread across threads: */
+/* alarms, movement and animation, alive zones, then collisions. Commands are applied at two sync points: */
+/* straight after the alarms, so that objects spawned by jobs the alarms start (e.g. the boss's bullet waves) */
+/* take part in the whole of the tick they appear in, and straight after the update, which destroys the objects */
+/* that have left their alive zones before collisions are checked. */
+/* BaseArcade::gameMain() is closed source, so its order is only known from how the game behaved on it: */
+/* objects killed by a collision vanished on the next tick, wherever they were. Here the stay-on-screen clamp */
+/* runs before the alive zone check, so updateObjects() leaves killed objects where they are rather than */
+/* pulling them back onto the screen. Destroyed objects are removed with removeGameObject(), which calls */
+/* objectDeleted() itself, so it must not be called for them again. */
+void ArcadeGame::updateWorld(float fSeconds)
+{
+	checkAlarms(fSeconds);
+	applyCommands();
+	if (m_LoadLevel < FrameGovernor::NO_COSMETICS)
+	{
+		m_Background.update(fSeconds);
+	}
 
-		/* Stop auto-correct when position is valid. */
-		if (isBetween(40, 90, m_pShip->getPosition().x) && m_pShip->getVelocity().x != 0)
+	m_vObjects.clear();
+	for (int i = 0; i < getNumGameObjects(); i++)
+	{
+		m_vObjects.push_back(getGameObject(i));
+	}
+
+	updateObjects(fSeconds);
+	applyCommands();
+	checkCollisions();
+}
+
+/* Returns true if an object is outside its alive zone. An alive zone of all zeros never ends. */
+static bool isOutsideAliveZone(GameObject* pGO)
+{
+	sf::IntRect& zone = pGO->getAliveZone();
+	bool bInfinite = zone.left == 0 && zone.top == 0 && zone.width == 0 && zone.height == 0;
+	return !bInfinite && !sf::FloatRect(zone).contains(pGO->getPosition());
+}
+
+/* Moves a range of objects in fixed point. Each object's movement for the tick is its speed times the tick's */
+/* length, rounded once to fixed point, then split along its direction. Positions and movements are gathered */
+/* into arrays first, so that the additions themselves are a plain integer loop the compiler can vectorize. */
+static void moveFixedPoint(std::vector<GameObject*>& vObjects, int iBegin, int iEnd, float fMicroseconds,
+						   sf::Int32* piX, sf::Int32* piY, sf::Int32* piStepX, sf::Int32* piStepY)
+{
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		GameObject* pGO = vObjects[i];
+		piX[i] = FixedPoint::fromFloat(pGO->getPosition().x);
+		piY[i] = FixedPoint::fromFloat(pGO->getPosition().y);
+		piStepX[i] = 0;
+		piStepY[i] = 0;
+		if (pGO->getAutoUpdatePosition())
 		{
-			m_pShip->setVelocity(0, m_pShip->getVelocity().y, s_kiOBJECT_DEFAULT_SPEED);
+			sf::Int32 iDistance = FixedPoint::fromFloat(pGO->getSpeedPerMicrosecond() * fMicroseconds);
+			piStepX[i] = FixedPoint::multiply(FixedPoint::fromFloat(pGO->getVelocity().x), iDistance);
+			piStepY[i] = FixedPoint::multiply(FixedPoint::fromFloat(pGO->getVelocity().y), iDistance);
 		}
 	}
-	else if (m_GameState == GameState::SCOREBOARD)
+
+	for (int i = iBegin; i < iEnd; i++)
 	{
-		setFontSize(30);
-		createMessage("Score this round: " + convertIntToString(m_iScore), 245, 50); 
-		createMessage("Highscores", 320, 100); 	
-		for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+		piX[i] += piStepX[i];
+		piY[i] += piStepY[i];
+	}
+
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		vObjects[i]->setPosition(FixedPoint::toFloat(piX[i]), FixedPoint::toFloat(piY[i]));
+	}
+}
+
+/* Moves and animates every object. Each object is only touched by one thread, so this is split across all of them. */
+/* Objects outside their alive zone afterwards are destroyed through the command buffer, keyed by their index, */
+/* so they are removed in list order whichever threads found them. They are not kept on the screen either: */
+/* killGameObject() moves objects out of their zone to kill them, and clamping them back would leave them in the game. */
+void ArcadeGame::updateObjects(float fSeconds)
+{
+	float fMicroseconds = fSeconds * 1000000;
+	std::vector<GameObject*>& vObjects = m_vObjects;
+	bool bAnimate = m_LoadLevel < FrameGovernor::NO_COSMETICS;
+	bool bFixedPoint = m_bFixedPoint;
+	sf::Int32* piX = NULL;
+	sf::Int32* piY = NULL;
+	sf::Int32* piStepX = NULL;
+	sf::Int32* piStepY = NULL;
+	if (bFixedPoint && !vObjects.empty())
+	{
+		m_viFixedX.resize(vObjects.size());
+		m_viFixedY.resize(vObjects.size());
+		m_viFixedStepX.resize(vObjects.size());
+		m_viFixedStepY.resize(vObjects.size());
+		piX = &m_viFixedX[0];
+		piY = &m_viFixedY[0];
+		piStepX = &m_viFixedStepX[0];
+		piStepY = &m_viFixedStepY[0];
+	}
+
+	CommandBuffer& commands = m_Commands;
+	m_Jobs.parallelForWithThreadIndex(0, static_cast<int>(vObjects.size()), 0, [&vObjects, &commands, fMicroseconds, bAnimate, bFixedPoint, piX, piY, piStepX, piStepY](int iThread, int iBegin, int iEnd)
+	{
+		if (bFixedPoint)
 		{
-			createMessage((convertIntToString(i + 1) + ")                " + convertIntToString(m_aiScores[i]) + " points"), 270, 160 + i * 30);
+			moveFixedPoint(vObjects, iBegin, iEnd, fMicroseconds, piX, piY, piStepX, piStepY);
 		}
-		createMessage(("Press 'R' to restart the game"), 220, 500);
 
-		if (sKeyPressed.compare("R") == 0)
+		for (int i = iBegin; i < iEnd; i++)
 		{
-			restartGame();
+			GameObject* pGO = vObjects[i];
+			if (!bFixedPoint && pGO->getAutoUpdatePosition())
+			{
+				pGO->updatePosition(fMicroseconds);
+			}
+
+			if (isOutsideAliveZone(pGO))
+			{
+				commands.destroy(iThread, i, pGO);
+			}
+			else if (pGO->getStayOnScreen())
+			{
+				sf::FloatRect bounds = pGO->getGlobalBounds();
+				sf::Vector2f offset(0, 0);
+				if (bounds.left < 0)
+					offset.x = -bounds.left;
+				else if (bounds.left + bounds.width > SCREEN_WIDTH)
+					offset.x = SCREEN_WIDTH - (bounds.left + bounds.width);
+				if (bounds.top < 0)
+					offset.y = -bounds.top;
+				else if (bounds.top + bounds.height > SCREEN_HEIGHT)
+					offset.y = SCREEN_HEIGHT - (bounds.top + bounds.height);
+				pGO->move(offset);
+			}
+
+			if (bAnimate && pGO->getNumFrames() > 0)
+			{
+				pGO->nextFrame();
+			}
+		}
+	});
+}
+
+/* A sync point for jobs that record changes to the game. removeGameObject() must not run concurrently, so */
+/* objects are added and removed here, on this thread, in the order of the commands' keys. Destroyed objects */
+/* are also taken out of the tick's list of objects. */
+void ArcadeGame::applyCommands()
+{
+	m_vpDestroyed.clear();
+	const std::vector<GameCommand>& vCommands = m_Commands.merge();
+	for (unsigned int i = 0; i < vCommands.size(); i++)
+	{
+		const GameCommand& command = vCommands[i];
+		switch (command.type)
+		{
+		case GameCommand::SPAWN:
+			addGameObject(command.pObject);
+			break;
+		case GameCommand::DESTROY:
+			m_vpDestroyed.push_back(command.pObject);
+			removeGameObject(command.pObject);
+			break;
+		}
+	}
+
+	if (!m_vpDestroyed.empty())
+	{
+		std::sort(m_vpDestroyed.begin(), m_vpDestroyed.end());
+		unsigned int iNumKept = 0;
+		for (unsigned int i = 0; i < m_vObjects.size(); i++)
+		{
+			if (!std::binary_search(m_vpDestroyed.begin(), m_vpDestroyed.end(), m_vObjects[i]))
+			{
+				m_vObjects[iNumKept++] = m_vObjects[i];
+			}
 		}
+		m_vObjects.resize(iNumKept);
 	}
+}
 
-	// leave this line of code here, last in the function.
-	BaseArcade::gameMain(sKeyPressed);
+/* Finds the colliding pairs among the objects present at the start of the pass, then reports them one at a time */
+/* in the order the objects were added. Objects spawned by collisionEvent() are first tested next tick. Objects */
+/* killed by an earlier report are skipped, and if a report clears the scene the rest are dropped. */
+void ArcadeGame::checkCollisions()
+{
+	m_CollisionDetector.findCollisions(m_vObjects, m_Jobs, m_vCollisions);
+
+	int iSceneGeneration = m_iSceneGeneration;
+	for (unsigned int i = 0; i < m_vCollisions.size() && iSceneGeneration == m_iSceneGeneration; i++)
+	{
+		GameObject* pGO1 = m_vObjects[m_vCollisions[i].first];
+		GameObject* pGO2 = m_vObjects[m_vCollisions[i].second];
+		if (pGO1->getSolid() && pGO2->getSolid() && pGO1->getGlobalBounds().intersects(pGO2->getGlobalBounds()))
+		{
+			collisionEvent(pGO1, pGO2);
+		}
+	}
 }
 
 /* Creates a Ship GameObject, setting up important parameters where necessary. */
 void ArcadeGame::spawnShip()
 {
-	Texture* pTexture = getTexture("shiptexture");
-	sf::IntRect* areaToLoad = new IntRect(0, 0, 79, 30);
-	pTexture->loadFromFile("images/ship.png", *areaToLoad);
-	m_pShip = new GameObject(pTexture, "ship");
+	m_pShip = new GameObject(m_apObjectTextures[OBJECT_SHIP], "ship");
 	m_pShip->setPosition(50, 300);
 	m_pShip->setVelocity(0, 0, s_kiOBJECT_DEFAULT_SPEED);
 	m_pShip->setStayOnScreen(true);
@@ -212,10 +526,7 @@ void ArcadeGame::spawnBoss()
 {
 	m_iBossHealth = 20;
 	m_bBossIsVulnerable = false;
-	Texture* pTexture = getTexture("bosstexture");
-	sf::IntRect* areaToLoad = new IntRect(75, 0, 75, 600);
-	pTexture->loadFromFile("images/boss.png", *areaToLoad);
-	GameObject* boss = new GameObject(pTexture, "boss");
+	GameObject* boss = new GameObject(m_apBossTextures[1], "boss");
 	boss->setPosition(770, 300);
 	boss->setStayOnScreen(false);
 	boss->setSolid(true);
@@ -224,18 +535,20 @@ void ArcadeGame::spawnBoss()
 
 /* Creates a BossBullet GameObject, setting up important parameters where necessary. */
 /* Boss bullets are offset when they are created to achieve a "wave" effect. */
-void ArcadeGame::spawnBossBullet(int iXOffset, int iYPosition)
+/* Only reads the game, so it can be called from jobs. The caller adds the bullet to the game. */
+/* Returns NULL if the boss is dead. */
+GameObject* ArcadeGame::createBossBullet(int iXOffset, int iYPosition) const
 {
 	if (m_iBossHealth > 0)
 	{
-		Texture* pTexture = getTexture("bossbullettexture");
-		GameObject* bullet = new GameObject(pTexture, "bossbullet");
+		GameObject* bullet = new GameObject(m_apObjectTextures[OBJECT_BOSS_BULLET], "bossbullet");
 		bullet->setPosition(730 + iXOffset, iYPosition);
 		bullet->setVelocity(-1, 0, (s_kiBULLET_SPEED * m_fDifficulty));
 		bullet->setStayOnScreen(false);
 		bullet->setAliveZone(-100, -100, 1000, 800);
-		addGameObject(bullet);
-	}		
+		return bullet;
+	}
+	return NULL;
 }
 
 /* Creates a Saucer GameObject, setting up important parameters where necessary. */
@@ -244,8 +557,7 @@ void ArcadeGame::spawnSaucer(int iXPositionOffset)
 {
 	if (m_GameState == GameState::SAUCER)
 	{
-		Texture* pTexture = getTexture("saucertexture");
-		GameObject* m_pSaucer = new GameObject(pTexture, "saucer");
+		GameObject* m_pSaucer = new GameObject(m_apObjectTextures[OBJECT_SAUCER], "saucer");
 		m_pSaucer->setPosition(900 + iXPositionOffset, 300);
 		m_pSaucer->setVelocity(-1, 0, (s_kiSAUCER_SPEED * m_fDifficulty));
 		m_pSaucer->setStayOnScreen(false);
@@ -260,8 +572,7 @@ void ArcadeGame::spawnComet()
 {
 	if (m_GameState == GameState::COMET)
 	{
-		Texture* pTexture = getTexture("comettexture");
-		GameObject* comet = new GameObject(pTexture, "comet");
+		GameObject* comet = new GameObject(m_apObjectTextures[OBJECT_COMET], "comet");
 		comet->setPosition(900, getRandom(600));
 		comet->setVelocity(-1, 0, (s_kiCOMET_SPEED * m_fDifficulty));
 		comet->setStayOnScreen(false);
@@ -274,8 +585,7 @@ void ArcadeGame::spawnComet()
 /* Creates a Bullet GameObject, setting up important parameters where necessary. */
 void ArcadeGame::spawnBullet()
 {
-	Texture* pTexture = getTexture("bullettexture");
-	GameObject* bullet = new GameObject(pTexture, "bullet");
+	GameObject* bullet = new GameObject(m_apObjectTextures[OBJECT_BULLET], "bullet");
 	bullet->setPosition(m_pShip->getPosition().x + 40, m_pShip->getPosition().y);
 	bullet->setVelocity(1, 0, s_kiBULLET_SPEED);
 	bullet->setStayOnScreen(false);
@@ -283,27 +593,40 @@ void ArcadeGame::spawnBullet()
 	addGameObject(bullet);	
 }
 
-/* Creates a HealthIndicator GameObject, setting up important parameters where necessary. */
-/* HealthIndicators use their index to position themselves correctly. */
-void ArcadeGame::spawnHealthIndicator(int iIndex)
-{
-	Texture* pTexture = getTexture("shiptexture");
-	GameObject* healthIndic = new GameObject(pTexture, "healthIndicator");
-	healthIndic->setPosition(38 + (73 * iIndex), 35);
-	healthIndic->setSolid(false);
-	addGameObject(healthIndic);	
-}
-
 /* Restarts the game, reverting all variables back to their default states excluding the Highscores array. */
+/* The first restart sets the game up from scratch and saves the result. Later restarts restore that instead, */
+/* keeping what a restart does not reset: the clock, the high scores, the random numbers and the background's */
+/* position. The stage being left is finished first, as changeGameState() would. The only other difference is */
+/* that the hidden scoreboard text goes back to how it was when the game started. */
 void ArcadeGame::restartGame()
 {
-	clearMessages();
-
-	for (int i = 0; i < getNumGameObjects(); i++)
+	sf::Clock clock;
+	if (m_bHasRestartSnapshot)
 	{
-		removeGameObject(getGameObject(i));
+		finishStage();
+
+		Snapshot::Fields& fields = m_RestartSnapshot.getFields();
+		fields.iTick = m_iTick;
+		fields.iGameStartTick = m_iTick;
+		for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+		{
+			fields.aiScores[i] = m_aiScores[i];
+		}
+		m_Random.getState(fields.random);
+		m_Background.saveState(m_RestartSnapshot.getBackground());
+
+		restoreState(m_RestartSnapshot);
+		m_iRestartTime = clock.getElapsedTime().asMicroseconds();
+		return;
 	}
 
+	showScoreboard(false);
+
+	/* Alarms are cancelled before the new stage starts, so that the stage's own alarms survive. */
+	cancelAllAlarms();
+
+	removeAllGameObjects();
+
 	modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_LEFT, true);
 	modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_RIGHT, true);
 	modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_UP, true);
@@ -321,21 +644,39 @@ void ArcadeGame::restartGame()
 	m_iNumSaucers = 0;
 	m_iNumComets = 0;
 
-	m_ActiveAlarms.clear();
-	m_GameStartTime = time(&m_GameStartTime);
+	m_iGameStartTick = m_iTick;
 
 	drawHealth();
 	revivePlayer();
+
+	saveState(m_RestartSnapshot);
+	m_bHasRestartSnapshot = true;
+	m_iRestartTime = clock.getElapsedTime().asMicroseconds();
+}
+
+sf::Int64 ArcadeGame::getRestartTime() const
+{
+	return m_iRestartTime;
+}
+
+/* Removes every GameObject. They are removed from the end of the list, as removing one moves those after it down. */
+void ArcadeGame::removeAllGameObjects()
+{
+	while (getNumGameObjects() > 0)
+	{
+		removeGameObject(getGameObject(getNumGameObjects() - 1));
+	}
+	m_iSceneGeneration++;
 }
 
 /* Ends the game and moves the game on to the Scoreboard stage. */
 void ArcadeGame::endGame()
 {
 	changeGameState(GameState::SCOREBOARD);
-	time_t gameEndTime = time(&gameEndTime);
-	modifyPlayerScore((gameEndTime - m_GameStartTime) * s_kiPOINTS_PER_SECOND);
+	modifyPlayerScore((m_iTick - m_iGameStartTick) / s_kiTICKS_PER_SECOND * s_kiPOINTS_PER_SECOND);
 	commitScore();
-	cancelAlarms();
+	cancelAllAlarms();
+	showScoreboard(true);
 }
 
 /* Add the score to the high scores list */
@@ -348,6 +689,46 @@ void ArcadeGame::commitScore()
 	bubbleSortScores();
 }
 
+/* Creates the text objects for the title and the scoreboard. They are hidden until their stage begins. */
+void ArcadeGame::createText()
+{
+	m_TextLayer.setSharedAtlas(&m_pAssets->font);
+
+	m_TitleText = m_TextLayer.createText("S C R A M B L E", 230, 100, s_kiTITLE_FONT_SIZE);
+	m_TextLayer.setVisible(m_TitleText, false);
+
+	m_RoundScoreText = m_TextLayer.createText("Score this round: ", 245, 50, s_kiSCOREBOARD_FONT_SIZE);
+	m_HighscoresText = m_TextLayer.createText("Highscores", 320, 100, s_kiSCOREBOARD_FONT_SIZE);
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		m_aScoreTexts[i] = m_TextLayer.createText(convertIntToString(i + 1) + ")                ", 270, 160 + i * 30, s_kiSCOREBOARD_FONT_SIZE);
+		m_TextLayer.setSuffix(m_aScoreTexts[i], " points");
+	}
+	m_RestartText = m_TextLayer.createText("Press 'R' to restart the game", 220, 500, s_kiSCOREBOARD_FONT_SIZE);
+	showScoreboard(false);
+}
+
+/* Shows or hides the scoreboard. The scores go straight to the text layer as integers. */
+void ArcadeGame::showScoreboard(bool bVisible)
+{
+	if (bVisible)
+	{
+		m_TextLayer.setInteger(m_RoundScoreText, m_iScore);
+		for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+		{
+			m_TextLayer.setInteger(m_aScoreTexts[i], m_aiScores[i]);
+		}
+	}
+
+	m_TextLayer.setVisible(m_RoundScoreText, bVisible);
+	m_TextLayer.setVisible(m_HighscoresText, bVisible);
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		m_TextLayer.setVisible(m_aScoreTexts[i], bVisible);
+	}
+	m_TextLayer.setVisible(m_RestartText, bVisible);
+}
+
 /* Called at the start of a new stage. */
 /* Does any set-up work required for the newly starting stage. */
 void ArcadeGame::initialiseStage()
@@ -356,6 +737,7 @@ void ArcadeGame::initialiseStage()
 	{
 	case GameState::INTRODUCTION:
 		createAlarm(ArcadeGame::Alarms::INTRO_STAGE_DURATION, s_kiINTRO_STAGE_DURATION);
+		m_TextLayer.setVisible(m_TitleText, true);
 		modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_LEFT, true);
 		modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_RIGHT, true);
 		modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_UP, true);
@@ -406,10 +788,7 @@ void ArcadeGame::initialiseStage()
 		modifyPlayerFlag(ArcadeGame::Flags::CAN_MOVE_DOWN, false);
 		modifyPlayerFlag(ArcadeGame::Flags::CAN_SHOOT, false);
 		modifyPlayerFlag(ArcadeGame::Flags::CAN_TAKE_DAMAGE, false);
-		for (int i = 0; i < getNumGameObjects(); i++)
-		{
-			removeGameObject(getGameObject(i));
-		}
+		removeAllGameObjects();
 		break;
 	}
 }
@@ -421,6 +800,7 @@ void ArcadeGame::finishStage()
 	switch (m_GameState)
 	{
 	case GameState::INTRODUCTION:
+		m_TextLayer.setVisible(m_TitleText, false);
 		break;
 	case GameState::INTERVAL:
 		break;
@@ -453,10 +833,21 @@ void ArcadeGame::bossAttack()
 	{
 		iAttackSpace = 405;
 	}
-	for (int i = 0; i < 9; i++)
+
+	/* The bullets of a wave are built by jobs and spawned through the command buffer, ordered by their */
+	/* place in the wave, so they are added in the same order however the jobs were split. */
+	CommandBuffer& commands = m_Commands;
+	m_Jobs.parallelForWithThreadIndex(0, s_kiBOSS_WAVE_SIZE, 0, [this, &commands, iAttackSpace](int iThread, int iBegin, int iEnd)
 	{
-		spawnBossBullet(i * 15, iAttackSpace + (i * 22));
-	}
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			GameObject* pBullet = createBossBullet(i * 15, iAttackSpace + (i * 22));
+			if (pBullet)
+			{
+				commands.spawn(iThread, i, pBullet);
+			}
+		}
+	});
 }
 
 /* Changes the GameState to the newly specified GameState. The previous GameState is passed down. */
@@ -469,66 +860,52 @@ void ArcadeGame::changeGameState(ArcadeGame::GameState newGameState)
 	initialiseStage();
 }
 
-/* Returns true if the Alarm exists in the ActiveAlarms array and is set to true. */
+/* Returns true if the Alarm is counting down. */
 bool ArcadeGame::alarmIsActive(Alarms alarm)
 {
-	if (m_ActiveAlarms[alarm] == true)
-	{
-		return true;
-	}
-	return false;
+	return m_abAlarmActive[alarm];
 }
 
-/* Removes an alarm from the ActiveAlarms list, allowing it to be created once again. */
+/* Stops an alarm, allowing it to be created once again. */
 void ArcadeGame::removeAlarm(Alarms alarm)
 {
-	m_ActiveAlarms.erase(alarm);
+	m_abAlarmActive[alarm] = false;
 }
 
 /* Used for creating alarms with the provided parameters. Alarms are added to a list of active alarms. */
-/* Alarms that do not match a pre-defined alarm name are not created (Prevents miss-spellings). */
 /* Alarms that already exist are not created. */
 void ArcadeGame::createAlarm(Alarms alarm, float fAlarmTime)
 {
 	if (!alarmIsActive(alarm))
 	{
-		switch (alarm)
+		m_abAlarmActive[alarm] = true;
+		m_afAlarmTimeRemaining[alarm] = fAlarmTime;
+	}
+}
+
+/* Counts down every active alarm and fires the ones that are due, in the order they are declared. */
+/* An alarm is no longer active by the time alarmComplete() is called, so it can be created again from there. */
+void ArcadeGame::checkAlarms(float fSeconds)
+{
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		if (m_abAlarmActive[i])
 		{
-		case ArcadeGame::Alarms::COMET_STAGE_DURATION:
-			setAlarm("CometStageDuration", fAlarmTime);	
-			break;
-		case ArcadeGame::Alarms::SAUCER_STAGE_DURATION:
-			setAlarm("SaucerStageDuration", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::INTERVAL_STAGE_DURATION:
-			setAlarm("IntervalStageDuration", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::INTRO_STAGE_DURATION:
-			setAlarm("IntroStageDuration", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::SHOT_FIRED:
-			setAlarm("ShotFired", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::SPAWN_COMET:
-			setAlarm("SpawnComet", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::SPAWN_SAUCER:
-			setAlarm("SpawnSaucer", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::REVIVE_IMMUNITY:
-			setAlarm("ReviveImmunity", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::BOSS_VULNERABILITY:
-			setAlarm("BossVulnerability", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::BOSS_ATTACK:
-			setAlarm("BossAttack", fAlarmTime);
-			break;
-		case ArcadeGame::Alarms::BOSS_DEATH:
-			setAlarm("BossDeath", fAlarmTime);
-			break;
+			m_afAlarmTimeRemaining[i] -= fSeconds;
+			if (m_afAlarmTimeRemaining[i] <= 0)
+			{
+				m_abAlarmActive[i] = false;
+				alarmComplete(s_kasALARM_IDS[i]);
+			}
 		}
-		m_ActiveAlarms[alarm] = true;
+	}
+}
+
+void ArcadeGame::cancelAllAlarms()
+{
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		m_abAlarmActive[i] = false;
 	}
 }
 
@@ -567,6 +944,7 @@ void ArcadeGame::alarmComplete(string sAlarmID)
 	else if (sAlarmID == "BossDeath")
 	{
 		removeGameObjectsOfType("boss");
+		m_iSceneGeneration++;
 		changeGameState(GameState::INTERVAL);
 		removeAlarm(Alarms::BOSS_DEATH);
 	}
@@ -625,94 +1003,835 @@ void ArcadeGame::animateBoss()
 {
 	if (getGameObject("boss"))
 	{
-		if (isBetween(11, 21, m_iBossHealth))
+		int iFrame;
+		if (!hasHealthRemaining("boss"))
 		{
-			if (m_bBossIsVulnerable == true)
-			{
-				Texture* pTexture = getTexture("bosstexture");
-				sf::IntRect* areaToLoad = new IntRect(0, 0, 75, 600);
-				pTexture->loadFromFile("images/boss.png", *areaToLoad);			
-				getGameObject("boss")->setTextureRect(*areaToLoad);
-			}
-			else
-			{
-				Texture* pTexture = getTexture("bosstexture");
-				sf::IntRect* areaToLoad = new IntRect(75, 0, 300, 600);
-				pTexture->loadFromFile("images/boss.png", *areaToLoad);	
-				getGameObject("boss")->setTextureRect(*areaToLoad);
-			}
+			iFrame = 4;
 		}
-		else if (isBetween(0, 11, m_iBossHealth))
+		else if (isBetween(11, 21, m_iBossHealth))
 		{
-			if (m_bBossIsVulnerable == true)
-			{
-				Texture* pTexture = getTexture("bosstexture");
-				sf::IntRect* areaToLoad = new IntRect(150, 0, 300, 600);
-				pTexture->loadFromFile("images/boss.png", *areaToLoad);	
-				getGameObject("boss")->setTextureRect(*areaToLoad);
-			}
-			else
-			{
-				Texture* pTexture = getTexture("bosstexture");
-				sf::IntRect* areaToLoad = new IntRect(225, 0, 300, 600);
-				pTexture->loadFromFile("images/boss.png", *areaToLoad);
-				getGameObject("boss")->setTextureRect(*areaToLoad);
-			}
+			iFrame = m_bBossIsVulnerable ? 0 : 1;
 		}
-		if (!hasHealthRemaining("boss"))
+		else
 		{
-			Texture* pTexture = getTexture("bosstexture");
-			sf::IntRect* areaToLoad = new IntRect(300, 0, 75, 600);
-			pTexture->loadFromFile("images/boss.png", *areaToLoad);	
-			getGameObject("boss")->setTextureRect(*areaToLoad);
+			iFrame = m_bBossIsVulnerable ? 2 : 3;
 		}
+		getGameObject("boss")->setTexture(*m_apBossTextures[iFrame], true);
 	}
 }
 
-/* Draws health indicators to the screen as GameObjects. */
+/* Updates the health indicators on the HUD. The HUD only rebuilds them if the health has actually changed. */
 void ArcadeGame::drawHealth()
 {
-	removeGameObjectsOfType("healthIndicator");
-	for (int i = 0; i < m_iPlayerHealth; i++)
-	{
-		spawnHealthIndicator(i);
-	}
+	m_Hud.setValue(m_HealthCounter, m_iPlayerHealth);
 }
 
+/* Builds the frame and hands it to the renderer. */
 void ArcadeGame::render()
 {
-	BaseArcade::render();
-
-	// any additional rendering you want to do add below this comment.
+	buildFrame(m_Frame);
+	m_pRenderer->renderFrame(m_Frame);
 }
 
-/* Instantly moves a GameObject outside of its alive zone to force it to die. */
-void ArcadeGame::killGameObject(GameObject* pGO)
+/* Adds the background, the GameObjects, the HUD and the text to the frame, in drawing order. */
+void ArcadeGame::buildFrame(RenderFrame& frame)
 {
-	pGO->setSolid(false);
-	pGO->setPosition(pGO->getAliveZone().left - 100, pGO->getAliveZone().top - 100);
-}
+	frame.clear();
+	m_Background.appendTo(frame);
 
-/* EVENT: Fired when a GameObject is deleted. */
-void ArcadeGame::objectDeleted(GameObject* pGO)
-{
-	if (pGO->getObjectType() == "comet")												
+	/* Animated GameObjects show the frame they are on, as BaseArcade::render() would do. */
+	for (int i = 0; i < getNumGameObjects(); i++)
 	{
-		m_iNumComets--;
+		GameObject* pGO = getGameObject(i);
+		if (pGO->getNumFrames() > 0)
+		{
+			pGO->setTextureRect(sf::IntRect(pGO->getFrame() * pGO->getWidth(), 0, pGO->getWidth(), pGO->getHeight()));
+		}
+
+		RenderQuad quad;
+		quad.pTexture = pGO->getTexture();
+		quad.dest = pGO->getGlobalBounds();
+		quad.source = sf::FloatRect(pGO->getTextureRect());
+		quad.colour = pGO->getColor();
+		quad.iKey = reinterpret_cast<std::size_t>(pGO);
+		frame.vSprites.push_back(quad);
 	}
-	else if (pGO->getObjectType() == "saucer")
+
+	m_Hud.appendTo(frame);
+
+	/* Under load, changed text is only laid out every few frames and the previous layout is shown meanwhile. */
+	m_iFramesSinceTextLayout++;
+	if (m_LoadLevel < FrameGovernor::NO_COSMETICS || m_iFramesSinceTextLayout >= s_kiLOADED_TEXT_LAYOUT_INTERVAL)
 	{
-		m_iNumSaucers--;
+		m_TextLayer.update();
+		m_iFramesSinceTextLayout = 0;
 	}
+	m_TextLayer.appendTo(frame);
 }
 
-/* EVENT: Fired when two GameObjects collide. */
-void ArcadeGame::collisionEvent(GameObject* pGO1, GameObject* pGO2)
+/* Everything that can change the scene without input is driven by moving objects, animation, scrolling, */
+/* text changes or alarms. If none but the scrolling are active, only the background differs from frame to frame. */
+bool ArcadeGame::isIdle()
 {
-	if (collisionWasBetween(pGO1, pGO2, "comet", "ship"))
-	{	
-		if (m_bCanTakeDamage)
-		{
+	for (int i = 0; i < getNumGameObjects(); i++)
+	{
+		GameObject* pGO = getGameObject(i);
+		if (pGO->getVelocity().x != 0 || pGO->getVelocity().y != 0 || pGO->getNumFrames() > 0)
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		if (m_abAlarmActive[i])
+		{
+			return false;
+		}
+	}
+
+	return !m_TextLayer.hasChanges();
+}
+
+JobSystem& ArcadeGame::getJobSystem()
+{
+	return m_Jobs;
+}
+
+ArcadeGame::Snapshot::Fields& ArcadeGame::Snapshot::getFields()
+{
+	return *reinterpret_cast<Fields*>(&vData[0]);
+}
+
+const ArcadeGame::Snapshot::Fields& ArcadeGame::Snapshot::getFields() const
+{
+	return *reinterpret_cast<const Fields*>(&vData[0]);
+}
+
+ArcadeGame::Snapshot::ObjectState* ArcadeGame::Snapshot::getObjects()
+{
+	return reinterpret_cast<ObjectState*>(&vData[0] + sizeof(Fields));
+}
+
+const ArcadeGame::Snapshot::ObjectState* ArcadeGame::Snapshot::getObjects() const
+{
+	return reinterpret_cast<const ObjectState*>(&vData[0] + sizeof(Fields));
+}
+
+float* ArcadeGame::Snapshot::getBackground()
+{
+	return reinterpret_cast<float*>(&vData[0] + sizeof(Fields) + getFields().iNumObjects * sizeof(ObjectState));
+}
+
+const float* ArcadeGame::Snapshot::getBackground() const
+{
+	return reinterpret_cast<const float*>(&vData[0] + sizeof(Fields) + getFields().iNumObjects * sizeof(ObjectState));
+}
+
+/* The block is sized first and then filled in place, so once it has grown to fit the scene nothing is allocated. */
+void ArcadeGame::saveState(Snapshot& snapshot)
+{
+	int iNumObjects = getNumGameObjects();
+	int iNumBackgroundValues = m_Background.getNumStateValues();
+	snapshot.vData.resize(sizeof(Snapshot::Fields) + iNumObjects * sizeof(Snapshot::ObjectState) + iNumBackgroundValues * sizeof(float));
+
+	Snapshot::Fields& fields = snapshot.getFields();
+	fields.iNumObjects = iNumObjects;
+	fields.iShip = -1;
+	fields.iNumBackgroundValues = iNumBackgroundValues;
+
+	Snapshot::ObjectState* pObjects = snapshot.getObjects();
+	for (int i = 0; i < iNumObjects; i++)
+	{
+		GameObject* pGO = getGameObject(i);
+		if (pGO == m_pShip)
+		{
+			fields.iShip = i;
+		}
+		saveObject(pGO, pObjects[i]);
+	}
+
+	fields.bCanMoveUp = m_bCanMoveUp;
+	fields.bCanMoveLeft = m_bCanMoveLeft;
+	fields.bCanMoveDown = m_bCanMoveDown;
+	fields.bCanMoveRight = m_bCanMoveRight;
+	fields.bCanShoot = m_bCanShoot;
+	fields.bCanTakeDamage = m_bCanTakeDamage;
+
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		fields.aiScores[i] = m_aiScores[i];
+	}
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		fields.abAlarmActive[i] = m_abAlarmActive[i];
+		fields.afAlarmTimeRemaining[i] = m_afAlarmTimeRemaining[i];
+	}
+	fields.iTick = m_iTick;
+	fields.iGameStartTick = m_iGameStartTick;
+	fields.fDifficulty = m_fDifficulty;
+	fields.iNumSaucers = m_iNumSaucers;
+	fields.iNumComets = m_iNumComets;
+
+	fields.iPlayerHealth = m_iPlayerHealth;
+	fields.iScore = m_iScore;
+	fields.iBossHealth = m_iBossHealth;
+	fields.bBossIsVulnerable = m_bBossIsVulnerable;
+
+	m_Random.getState(fields.random);
+	fields.gameState = m_GameState;
+	fields.previousGameState = m_PreviousGameState;
+	fields.iHealthCounter = m_Hud.getValue(m_HealthCounter);
+
+	m_Background.saveState(snapshot.getBackground());
+	m_TextLayer.saveState(snapshot.text);
+}
+
+/* Objects are overwritten in place, position by position in the list. Objects left over are removed from the end, */
+/* with events paused as the counts objectDeleted() keeps are restored anyway, and any still missing are added. */
+void ArcadeGame::restoreState(const Snapshot& snapshot)
+{
+	const Snapshot::Fields& fields = snapshot.getFields();
+	const Snapshot::ObjectState* pObjects = snapshot.getObjects();
+
+	int iNumReused = std::min(fields.iNumObjects, getNumGameObjects());
+	for (int i = 0; i < iNumReused; i++)
+	{
+		restoreObject(pObjects[i], getGameObject(i));
+	}
+
+	pauseEvents(true);
+	while (getNumGameObjects() > fields.iNumObjects)
+	{
+		removeGameObject(getGameObject(getNumGameObjects() - 1));
+	}
+	pauseEvents(false);
+	for (int i = iNumReused; i < fields.iNumObjects; i++)
+	{
+		GameObject* pGO = new GameObject(m_vPrototypes[pObjects[i].iType]);
+		restoreObject(pObjects[i], pGO);
+		addGameObject(pGO);
+	}
+	m_pShip = fields.iShip >= 0 ? getGameObject(fields.iShip) : NULL;
+	m_vObjects.clear();
+	m_iSceneGeneration++;
+
+	m_bCanMoveUp = fields.bCanMoveUp;
+	m_bCanMoveLeft = fields.bCanMoveLeft;
+	m_bCanMoveDown = fields.bCanMoveDown;
+	m_bCanMoveRight = fields.bCanMoveRight;
+	m_bCanShoot = fields.bCanShoot;
+	m_bCanTakeDamage = fields.bCanTakeDamage;
+
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		m_aiScores[i] = fields.aiScores[i];
+	}
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		m_abAlarmActive[i] = fields.abAlarmActive[i];
+		m_afAlarmTimeRemaining[i] = fields.afAlarmTimeRemaining[i];
+	}
+	m_iTick = fields.iTick;
+	m_iGameStartTick = fields.iGameStartTick;
+	m_fDifficulty = fields.fDifficulty;
+	m_iNumSaucers = fields.iNumSaucers;
+	m_iNumComets = fields.iNumComets;
+
+	m_iPlayerHealth = fields.iPlayerHealth;
+	m_iScore = fields.iScore;
+	m_iBossHealth = fields.iBossHealth;
+	m_bBossIsVulnerable = fields.bBossIsVulnerable;
+
+	m_Random.setState(fields.random);
+	m_GameState = fields.gameState;
+	m_PreviousGameState = fields.previousGameState;
+	m_Hud.setValue(m_HealthCounter, fields.iHealthCounter);
+
+	m_Background.restoreState(snapshot.getBackground(), fields.iNumBackgroundValues);
+	m_TextLayer.restoreState(snapshot.text);
+}
+
+/* The snapshot is kept, so forking again does not allocate. */
+void ArcadeGame::fork(ArcadeGame& game)
+{
+	game.setFixedPoint(m_bFixedPoint);
+	saveState(m_ForkSnapshot);
+	game.restoreState(m_ForkSnapshot);
+}
+
+ArcadeGame::GameState ArcadeGame::getGameState() const
+{
+	return m_GameState;
+}
+
+int ArcadeGame::getScore() const
+{
+	return m_iScore;
+}
+
+int ArcadeGame::getPlayerHealth() const
+{
+	return m_iPlayerHealth;
+}
+
+sf::Vector2f ArcadeGame::getPlayerPosition() const
+{
+	return m_pShip ? m_pShip->getPosition() : sf::Vector2f(0, 0);
+}
+
+/* Only a few objects are wanted, so each one found is put in its place by moving the further ones along. */
+int ArcadeGame::findNearestObjects(ObjectTypes type, int iMaxObjects, float* pfOffsets)
+{
+	sf::Vector2f player = getPlayerPosition();
+	m_vfNearestDistances.resize(iMaxObjects > 0 ? iMaxObjects : 0);
+	int iNumFound = 0;
+	for (int i = 0; i < getNumGameObjects(); i++)
+	{
+		GameObject* pGO = getGameObject(i);
+		int iType;
+		int iTextureFrame;
+		identifyObject(pGO, iType, iTextureFrame);
+		if (iType != type)
+		{
+			continue;
+		}
+
+		float fX = pGO->getPosition().x - player.x;
+		float fY = pGO->getPosition().y - player.y;
+		float fDistance = fX * fX + fY * fY;
+		int iPlace = iNumFound < iMaxObjects ? iNumFound++ : iMaxObjects;
+		while (iPlace > 0 && m_vfNearestDistances[iPlace - 1] > fDistance)
+		{
+			if (iPlace < iMaxObjects)
+			{
+				m_vfNearestDistances[iPlace] = m_vfNearestDistances[iPlace - 1];
+				pfOffsets[2 * iPlace] = pfOffsets[2 * iPlace - 2];
+				pfOffsets[2 * iPlace + 1] = pfOffsets[2 * iPlace - 1];
+			}
+			iPlace--;
+		}
+		if (iPlace < iMaxObjects)
+		{
+			m_vfNearestDistances[iPlace] = fDistance;
+			pfOffsets[2 * iPlace] = fX;
+			pfOffsets[2 * iPlace + 1] = fY;
+		}
+	}
+	return iNumFound;
+}
+
+/* Mixes a value into a hash. The multiply spreads each bit of the value over the bits above it and the shift */
+/* brings the top bits back down, so values that differ by one bit give unrelated hashes. */
+static sf::Uint64 hashValue(sf::Uint64 iHash, sf::Uint64 iValue)
+{
+	iHash = (iHash ^ iValue) * 0x9E3779B97F4A7C15ULL;
+	return iHash ^ (iHash >> 29);
+}
+
+static sf::Uint64 hashFloat(sf::Uint64 iHash, float fValue)
+{
+	sf::Uint32 iBits;
+	memcpy(&iBits, &fValue, sizeof(iBits));
+	return hashValue(iHash, iBits);
+}
+
+/* Objects are hashed from the same record saveState() takes, so the hash covers exactly what a snapshot does. */
+/* Each thread writes only its own objects' slots, and the slots are added up once they are all done. */
+/* Nothing is carried over between calls: every moving object changes every tick, and BaseArcade's setters */
+/* cannot be watched, so a running hash would still have to visit every object to stay correct. */
+sf::Uint64 ArcadeGame::hashState()
+{
+	std::vector<ObjectHash>& vObjectHashes = m_vObjectHashes;
+	vObjectHashes.resize(getNumGameObjects());
+	m_Jobs.parallelFor(0, static_cast<int>(vObjectHashes.size()), 0, [this, &vObjectHashes](int iBegin, int iEnd)
+	{
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			Snapshot::ObjectState object;
+			saveObject(getGameObject(i), object);
+			vObjectHashes[i].sType = s_kasOBJECT_TYPES[object.iType];
+			vObjectHashes[i].iHash = hashObject(object);
+			vObjectHashes[i].position = object.position;
+		}
+	});
+
+	sf::Uint64 iHash = 0;
+	iHash = hashValue(iHash, m_bCanMoveUp | m_bCanMoveLeft << 1 | m_bCanMoveDown << 2 | m_bCanMoveRight << 3 |
+							 m_bCanShoot << 4 | m_bCanTakeDamage << 5);
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		iHash = hashValue(iHash, m_aiScores[i]);
+	}
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		iHash = hashValue(iHash, m_abAlarmActive[i]);
+		iHash = hashFloat(iHash, m_afAlarmTimeRemaining[i]);
+	}
+	iHash = hashValue(iHash, m_iTick);
+	iHash = hashValue(iHash, m_iGameStartTick);
+	iHash = hashFloat(iHash, m_fDifficulty);
+	iHash = hashValue(iHash, m_iNumSaucers);
+	iHash = hashValue(iHash, m_iNumComets);
+	iHash = hashValue(iHash, m_iPlayerHealth);
+	iHash = hashValue(iHash, m_iScore);
+	iHash = hashValue(iHash, m_iBossHealth);
+	iHash = hashValue(iHash, m_bBossIsVulnerable);
+
+	Random::State random;
+	m_Random.getState(random);
+	for (int i = 0; i < 4; i++)
+	{
+		iHash = hashValue(iHash, random.aiWords[i]);
+	}
+	iHash = hashValue(iHash, m_GameState);
+	iHash = hashValue(iHash, m_PreviousGameState);
+
+	m_vfHashedBackground.resize(m_Background.getNumStateValues());
+	if (!m_vfHashedBackground.empty())
+	{
+		m_Background.saveState(&m_vfHashedBackground[0]);
+	}
+	for (unsigned int i = 0; i < m_vfHashedBackground.size(); i++)
+	{
+		iHash = hashFloat(iHash, m_vfHashedBackground[i]);
+	}
+
+	for (unsigned int i = 0; i < vObjectHashes.size(); i++)
+	{
+		iHash += vObjectHashes[i].iHash;
+	}
+	return iHash;
+}
+
+const std::vector<ArcadeGame::ObjectHash>& ArcadeGame::getObjectHashes() const
+{
+	return m_vObjectHashes;
+}
+
+sf::Uint64 ArcadeGame::hashObject(const Snapshot::ObjectState& object)
+{
+	sf::Uint64 iHash = hashValue(object.iType, object.iTextureFrame);
+	iHash = hashFloat(iHash, object.position.x);
+	iHash = hashFloat(iHash, object.position.y);
+	iHash = hashFloat(iHash, object.velocity.x);
+	iHash = hashFloat(iHash, object.velocity.y);
+	iHash = hashFloat(iHash, object.fSpeedPerMicrosecond);
+	iHash = hashValue(iHash, object.iFrame);
+	iHash = hashValue(iHash, object.bSolid | object.bStayOnScreen << 1 | object.bAutoUpdatePosition << 2);
+	iHash = hashValue(iHash, object.aliveZone.left);
+	iHash = hashValue(iHash, object.aliveZone.top);
+	iHash = hashValue(iHash, object.aliveZone.width);
+	return hashValue(iHash, object.aliveZone.height);
+}
+
+/* Objects are told apart by their texture, which is quicker than comparing their type names. */
+/* Every object is one of the ObjectTypes, so one that is none of the others is a boss bullet. */
+void ArcadeGame::identifyObject(const GameObject* pGO, int& iType, int& iTextureFrame)
+{
+	const sf::Texture* pTexture = pGO->getTexture();
+	iTextureFrame = 0;
+	for (int i = 0; i < s_kiNUM_BOSS_FRAMES; i++)
+	{
+		if (pTexture == m_apBossTextures[i])
+		{
+			iType = OBJECT_BOSS;
+			iTextureFrame = i;
+			return;
+		}
+	}
+	for (iType = 0; iType < NUM_OBJECT_TYPES - 1; iType++)
+	{
+		if (pTexture == m_apObjectTextures[iType])
+		{
+			return;
+		}
+	}
+}
+
+/* Returns the texture of an object of the given type. The boss changes texture as it animates, so iTextureFrame */
+/* picks which of its frames to use. */
+sf::Texture* ArcadeGame::getObjectTexture(int iType, int iTextureFrame)
+{
+	if (iType == OBJECT_BOSS)
+	{
+		return m_apBossTextures[iTextureFrame];
+	}
+	return m_apObjectTextures[iType];
+}
+
+void ArcadeGame::saveObject(GameObject* pGO, Snapshot::ObjectState& object)
+{
+	int iType;
+	int iTextureFrame;
+	identifyObject(pGO, iType, iTextureFrame);
+	object.iType = static_cast<sf::Uint8>(iType);
+	object.iTextureFrame = static_cast<sf::Uint8>(iTextureFrame);
+	object.position = pGO->getPosition();
+	object.velocity = pGO->getVelocity();
+	object.fSpeedPerMicrosecond = pGO->getSpeedPerMicrosecond();
+	object.aliveZone = pGO->getAliveZone();
+	object.iFrame = pGO->getFrame();
+	object.bSolid = pGO->getSolid();
+	object.bStayOnScreen = pGO->getStayOnScreen();
+	object.bAutoUpdatePosition = pGO->getAutoUpdatePosition();
+}
+
+/* GameObject keeps its speed per microsecond and setSpeed() divides by a million, so converting back to a speed per */
+/* second is not always exact. The speeds either side are tried until one gives back exactly the value saved. */
+static void setSpeedPerMicrosecond(GameObject& go, float fSpeed)
+{
+	float fPerSecond = fSpeed * 1000000.0f;
+	sf::Uint32 iBits;
+	memcpy(&iBits, &fPerSecond, sizeof(iBits));
+	for (int i = 0; i < 16; i++)
+	{
+		sf::Uint32 iTryBits = iBits + ((i % 2 == 0) ? (i / 2) : -(i / 2 + 1));
+		float fTry;
+		memcpy(&fTry, &iTryBits, sizeof(fTry));
+		go.setSpeed(fTry);
+		if (go.getSpeedPerMicrosecond() == fSpeed)
+		{
+			return;
+		}
+	}
+	go.setSpeed(fPerSecond);
+}
+
+/* An object of another type is first turned into the right one by copying the type's prototype over it, as the type */
+/* cannot be changed otherwise. Setters that do more than store a value are only called if the value has changed: */
+/* setSpeed() involves a search, and setFrame() wraps the frame by the number of frames, which is 0 for objects */
+/* that are not animated. */
+void ArcadeGame::restoreObject(const Snapshot::ObjectState& object, GameObject* pGO)
+{
+	sf::Texture* pTexture = getObjectTexture(object.iType, object.iTextureFrame);
+	if (pGO->getTexture() != pTexture)
+	{
+		*pGO = m_vPrototypes[object.iType];
+		if (pGO->getTexture() != pTexture)
+		{
+			pGO->setTexture(*pTexture, true);
+		}
+	}
+
+	pGO->setPosition(object.position);
+	pGO->getVelocity() = object.velocity;
+	if (pGO->getSpeedPerMicrosecond() != object.fSpeedPerMicrosecond)
+	{
+		setSpeedPerMicrosecond(*pGO, object.fSpeedPerMicrosecond);
+	}
+	pGO->getAliveZone() = object.aliveZone;
+	if (pGO->getFrame() != object.iFrame)
+	{
+		pGO->setFrame(object.iFrame);
+	}
+	pGO->setSolid(object.bSolid);
+	pGO->setStayOnScreen(object.bStayOnScreen);
+	pGO->setAutoUpdatePosition(object.bAutoUpdatePosition);
+}
+
+/* The frame is built before restoring, as it is a copy and does not refer back to the objects it shows. */
+void ArcadeGame::buildRunAheadFrame(const InputState& input, int iTicks, RenderFrame& frame)
+{
+	sf::Clock clock;
+	saveState(m_RunAheadSnapshot);
+	m_RunAheadCost.iSaveTime = clock.restart().asMicroseconds();
+
+	InputState heldKeys = input;
+	heldKeys.newFrame();
+	for (int i = 0; i < iTicks; i++)
+	{
+		gameMain(heldKeys);
+	}
+	buildFrame(frame);
+	m_RunAheadCost.iSimulateTime = clock.restart().asMicroseconds();
+
+	restoreState(m_RunAheadSnapshot);
+	m_RunAheadCost.iRestoreTime = clock.restart().asMicroseconds();
+}
+
+const ArcadeGame::RunAheadCost& ArcadeGame::getRunAheadCost() const
+{
+	return m_RunAheadCost;
+}
+
+void ArcadeGame::writeState(ByteWriter& out)
+{
+	Snapshot snapshot;
+	saveState(snapshot);
+	writeSnapshot(snapshot, out);
+}
+
+bool ArcadeGame::readState(ByteReader& in)
+{
+	Snapshot snapshot;
+	if (!readSnapshot(in, snapshot))
+	{
+		return false;
+	}
+	restoreState(snapshot);
+	return true;
+}
+
+/* Objects are written in list order, with the fields BaseArcade and the game actually change. The type is */
+/* written by name, so files do not depend on the order of ObjectTypes. */
+void ArcadeGame::writeSnapshot(const Snapshot& snapshot, ByteWriter& out)
+{
+	const Snapshot::Fields& fields = snapshot.getFields();
+	const Snapshot::ObjectState* pObjects = snapshot.getObjects();
+
+	out.writeVarint(fields.iNumObjects);
+	for (int i = 0; i < fields.iNumObjects; i++)
+	{
+		const Snapshot::ObjectState& object = pObjects[i];
+		out.writeString(s_kasOBJECT_TYPES[object.iType]);
+		out.writeUint8(object.iTextureFrame);
+		out.writeFloat(object.position.x);
+		out.writeFloat(object.position.y);
+		out.writeFloat(object.velocity.x);
+		out.writeFloat(object.velocity.y);
+		out.writeFloat(object.fSpeedPerMicrosecond);
+		out.writeInt32(object.iFrame);
+		out.writeBool(object.bSolid);
+		out.writeBool(object.bStayOnScreen);
+		out.writeBool(object.bAutoUpdatePosition);
+		out.writeInt32(object.aliveZone.left);
+		out.writeInt32(object.aliveZone.top);
+		out.writeInt32(object.aliveZone.width);
+		out.writeInt32(object.aliveZone.height);
+	}
+	out.writeInt32(fields.iShip);
+
+	out.writeBool(fields.bCanMoveUp);
+	out.writeBool(fields.bCanMoveLeft);
+	out.writeBool(fields.bCanMoveDown);
+	out.writeBool(fields.bCanMoveRight);
+	out.writeBool(fields.bCanShoot);
+	out.writeBool(fields.bCanTakeDamage);
+
+	out.writeVarint(s_kiNUM_SCORES_STORED);
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		out.writeInt32(fields.aiScores[i]);
+	}
+	out.writeVarint(NUM_ALARMS);
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		out.writeBool(fields.abAlarmActive[i]);
+		out.writeFloat(fields.afAlarmTimeRemaining[i]);
+	}
+	out.writeInt32(fields.iTick);
+	out.writeInt32(fields.iGameStartTick);
+	out.writeFloat(fields.fDifficulty);
+	out.writeInt32(fields.iNumSaucers);
+	out.writeInt32(fields.iNumComets);
+
+	out.writeInt32(fields.iPlayerHealth);
+	out.writeInt32(fields.iScore);
+	out.writeInt32(fields.iBossHealth);
+	out.writeBool(fields.bBossIsVulnerable);
+
+	for (int i = 0; i < 4; i++)
+	{
+		out.writeUint32(fields.random.aiWords[i]);
+	}
+	out.writeUint8(static_cast<sf::Uint8>(fields.gameState));
+	out.writeUint8(static_cast<sf::Uint8>(fields.previousGameState));
+
+	TextLayer::writeState(snapshot.text, out);
+	const float* pfBackground = snapshot.getBackground();
+	out.writeVarint(fields.iNumBackgroundValues);
+	for (int i = 0; i < fields.iNumBackgroundValues; i++)
+	{
+		out.writeFloat(pfBackground[i]);
+	}
+	out.writeInt32(fields.iHealthCounter);
+}
+
+/* The block is resized once the number of objects is known, and again once the number of background values is. */
+/* Every record takes more than a byte, so a count larger than the bytes left is rejected before allocating. */
+bool ArcadeGame::readSnapshot(ByteReader& in, Snapshot& snapshot)
+{
+	sf::Uint64 iNumObjects = in.readVarint();
+	if (iNumObjects > in.getRemaining())
+	{
+		return false;
+	}
+	snapshot.vData.resize(sizeof(Snapshot::Fields) + static_cast<std::size_t>(iNumObjects) * sizeof(Snapshot::ObjectState));
+	snapshot.getFields().iNumObjects = static_cast<int>(iNumObjects);
+
+	Snapshot::ObjectState* pObjects = snapshot.getObjects();
+	for (int i = 0; i < static_cast<int>(iNumObjects) && in.isValid(); i++)
+	{
+		Snapshot::ObjectState& object = pObjects[i];
+		std::string sGOType = in.readString();
+		int iType = 0;
+		while (iType < NUM_OBJECT_TYPES && sGOType != s_kasOBJECT_TYPES[iType])
+		{
+			iType++;
+		}
+		int iTextureFrame = in.readUint8();
+		if (iType == NUM_OBJECT_TYPES || (iType == OBJECT_BOSS && iTextureFrame >= s_kiNUM_BOSS_FRAMES))
+		{
+			return false;
+		}
+		object.iType = static_cast<sf::Uint8>(iType);
+		object.iTextureFrame = static_cast<sf::Uint8>(iType == OBJECT_BOSS ? iTextureFrame : 0);
+		object.position.x = in.readFloat();
+		object.position.y = in.readFloat();
+		object.velocity.x = in.readFloat();
+		object.velocity.y = in.readFloat();
+		object.fSpeedPerMicrosecond = in.readFloat();
+		object.iFrame = in.readInt32();
+		object.bSolid = in.readBool();
+		object.bStayOnScreen = in.readBool();
+		object.bAutoUpdatePosition = in.readBool();
+		object.aliveZone.left = in.readInt32();
+		object.aliveZone.top = in.readInt32();
+		object.aliveZone.width = in.readInt32();
+		object.aliveZone.height = in.readInt32();
+	}
+
+	Snapshot::Fields& fields = snapshot.getFields();
+	fields.iShip = in.readInt32();
+	if (fields.iShip < -1 || fields.iShip >= fields.iNumObjects)
+	{
+		return false;
+	}
+
+	fields.bCanMoveUp = in.readBool();
+	fields.bCanMoveLeft = in.readBool();
+	fields.bCanMoveDown = in.readBool();
+	fields.bCanMoveRight = in.readBool();
+	fields.bCanShoot = in.readBool();
+	fields.bCanTakeDamage = in.readBool();
+
+	if (in.readVarint() != s_kiNUM_SCORES_STORED)
+	{
+		return false;
+	}
+	for (int i = 0; i < s_kiNUM_SCORES_STORED; i++)
+	{
+		fields.aiScores[i] = in.readInt32();
+	}
+	if (in.readVarint() != NUM_ALARMS)
+	{
+		return false;
+	}
+	for (int i = 0; i < NUM_ALARMS; i++)
+	{
+		fields.abAlarmActive[i] = in.readBool();
+		fields.afAlarmTimeRemaining[i] = in.readFloat();
+	}
+	fields.iTick = in.readInt32();
+	fields.iGameStartTick = in.readInt32();
+	fields.fDifficulty = in.readFloat();
+	fields.iNumSaucers = in.readInt32();
+	fields.iNumComets = in.readInt32();
+
+	fields.iPlayerHealth = in.readInt32();
+	fields.iScore = in.readInt32();
+	fields.iBossHealth = in.readInt32();
+	fields.bBossIsVulnerable = in.readBool();
+
+	for (int i = 0; i < 4; i++)
+	{
+		fields.random.aiWords[i] = in.readUint32();
+	}
+	int iGameState = in.readUint8();
+	int iPreviousGameState = in.readUint8();
+	if (iGameState > SCOREBOARD || iPreviousGameState > SCOREBOARD)
+	{
+		return false;
+	}
+	fields.gameState = static_cast<GameState>(iGameState);
+	fields.previousGameState = static_cast<GameState>(iPreviousGameState);
+
+	if (!TextLayer::readState(in, snapshot.text))
+	{
+		return false;
+	}
+	sf::Uint64 iNumBackgroundValues = in.readVarint();
+	if (iNumBackgroundValues > in.getRemaining() / sizeof(float))
+	{
+		return false;
+	}
+	fields.iNumBackgroundValues = static_cast<int>(iNumBackgroundValues);
+	snapshot.vData.resize(snapshot.vData.size() + static_cast<std::size_t>(iNumBackgroundValues) * sizeof(float));
+
+	float* pfBackground = snapshot.getBackground();
+	for (int i = 0; i < snapshot.getFields().iNumBackgroundValues; i++)
+	{
+		pfBackground[i] = in.readFloat();
+	}
+	snapshot.getFields().iHealthCounter = in.readInt32();
+	return in.isValid();
+}
+
+void ArcadeGame::setLoadLevel(FrameGovernor::Level level)
+{
+	m_LoadLevel = level;
+}
+
+FrameGovernor::Level ArcadeGame::getLoadLevel() const
+{
+	return m_LoadLevel;
+}
+
+void ArcadeGame::setFixedPoint(bool bFixedPoint)
+{
+	m_bFixedPoint = bFixedPoint;
+}
+
+bool ArcadeGame::isFixedPoint() const
+{
+	return m_bFixedPoint;
+}
+
+/* Spawning is slowed down rather than stopped, so the stages still play out under load. */
+float ArcadeGame::getSpawnIntervalScale()
+{
+	return m_LoadLevel >= FrameGovernor::CAPPED_SPAWNS ? static_cast<float>(s_kiLOADED_SPAWN_INTERVAL_SCALE) : 1.0f;
+}
+
+void ArcadeGame::setRenderer(Renderer* pRenderer)
+{
+	m_pRenderer = pRenderer ? pRenderer : &m_WindowRenderer;
+}
+
+/* Instantly moves a GameObject outside of its alive zone to force it to die. */
+void ArcadeGame::killGameObject(GameObject* pGO)
+{
+	pGO->setSolid(false);
+	pGO->setPosition(pGO->getAliveZone().left - 100, pGO->getAliveZone().top - 100);
+}
+
+/* EVENT: Fired when a GameObject is deleted. */
+void ArcadeGame::objectDeleted(GameObject* pGO)
+{
+	/* The ship is steered every tick, so it must not be left pointing at a deleted object. */
+	if (pGO == m_pShip)
+	{
+		m_pShip = NULL;
+	}
+
+	if (pGO->getObjectType() == "comet")												
+	{
+		m_iNumComets--;
+	}
+	else if (pGO->getObjectType() == "saucer")
+	{
+		m_iNumSaucers--;
+	}
+}
+
+/* EVENT: Fired when two GameObjects collide. */
+void ArcadeGame::collisionEvent(GameObject* pGO1, GameObject* pGO2)
+{
+	if (collisionWasBetween(pGO1, pGO2, "comet", "ship"))
+	{	
+		if (m_bCanTakeDamage)
+		{
 			killGameObject(selectGOType("ship", pGO1, pGO2));
 			modifyPlayerHealth(-1);
 			if (hasHealthRemaining("player"))
@@ -950,7 +2069,7 @@ string ArcadeGame::convertIntToString(int iNumber)
 /* Returns a random number between 1 and iMaxValue (Inclusive). */
 int ArcadeGame::getRandom(int iMaxValue)
 {
-	return rand() % iMaxValue + 1;
+	return m_Random.getInt(1, iMaxValue);
 }
 
 /* Returns true if iValue is between iLower and iUpper (Exclusive). */
@@ -958,3 +2077,9 @@ bool ArcadeGame::isBetween(int iLower, int iUpper, int iValue)
 {
 	return (iLower <iValue && iValue < iUpper);
 }
+
+/* Returns -1, 0 or 1. */
+float ArcadeGame::getSign(float fValue)
+{
+	return static_cast<float>((fValue > 0) - (fValue < 0));
+}
@@ -2,6 +2,20 @@
 #define ARCADE_G_H
 
 #include "BaseArcade.h"
+#include "TextLayer.h"
+#include "HudLayer.h"
+#include "ParallaxBackground.h"
+#include "RenderFrame.h"
+#include "WindowRenderer.h"
+#include "JobSystem.h"
+#include "CollisionDetector.h"
+#include "CommandBuffer.h"
+#include "InputState.h"
+#include "FrameGovernor.h"
+#include "Random.h"
+#include "ByteStream.h"
+#include "FixedPoint.h"
+#include <memory>
 
 #define PI 3.142
 
@@ -9,21 +23,222 @@ class ArcadeGame: public BaseArcade
 {
 public:
 	static enum GameState {INTRODUCTION, INTERVAL, COMET, SAUCER, BOSS, SCOREBOARD};
+	//! The types of GameObject, as looked for by findNearestObjects().
+	static enum ObjectTypes {OBJECT_SHIP, OBJECT_BOSS, OBJECT_COMET, OBJECT_SAUCER, OBJECT_BULLET, OBJECT_BOSS_BULLET, NUM_OBJECT_TYPES};
 
 	static const int s_kiOBJECT_DEFAULT_SPEED = 200;
 
-	ArcadeGame(sf::RenderWindow& rw);
+	//! The textures and font the game draws with, which can be loaded once and shared by many games.
+	class Assets;
+
+	//! ArcadeGame constructor. The game loads assets of its own.
+	/*!
+	\param rw the window to play in.
+	\param iSeed the seed for the game's random numbers. A game given the same seed and the same input makes the same choices.
+	\param iNumWorkers the number of threads the game starts to split its own updates across. The default, 0, runs
+	everything on the calling thread, so that extra games (e.g. a bot's) do not compete with the main game for
+	cores. Use -1 for the main game, to start one fewer than the number of hardware threads.
+	*/
+	ArcadeGame(sf::RenderWindow& rw, sf::Uint64 iSeed, int iNumWorkers = 0);
+
+	//! ArcadeGame constructor, for a game that shares its assets with others, e.g. one of many run side by side.
+	/*!
+	Apart from the assets, each game is self-contained: its clock is its tick count, and its random numbers,
+	alarms and GameObjects are its own. Different games can therefore be stepped on different threads at once.
+	\param rw the window to play in. Games that are never drawn can all be given the same window, never opened.
+	\param iSeed the seed for the game's random numbers.
+	\param assets the assets, already loaded. They are only read, and must outlive the game.
+	\param iNumWorkers the number of threads the game starts to split its own updates across. Use 0 when many
+	games are stepped at once on a pool of threads, so that each runs on the thread that steps it.
+	*/
+	ArcadeGame(sf::RenderWindow& rw, sf::Uint64 iSeed, const Assets& assets, int iNumWorkers);
+
+	//! Get the game's assets, e.g. to share them with another game.
+	const Assets& getAssets() const;
+
+	//! ArcadeGame destructor. It is virtual, since games are deleted through ArcadeGame pointers, e.g. by SessionPool.
+	virtual ~ArcadeGame();
 
 	void alarmComplete(std::string sAlarmID);
-	void gameMain(std::string sKeyPressed);
+	void gameMain(const InputState& input);
 	void collisionEvent(GameObject* pGO1, GameObject* pGO2);
 	void objectDeleted(GameObject* pGO);
 	/*!
-	This derived class function exists only for additional rendering not dealt with by BaseArcade::render().
-	BaseArcade::render() renders only GameObjects and text. Other rendering needs to go in this function.
+	ArcadeGame draws the whole frame itself rather than calling BaseArcade::render(), because the parallax
+	background has to be drawn underneath the GameObjects. The order is background, GameObjects, HUD, text.
+	The frame is built as a RenderFrame and handed to the current Renderer.
 	*/
 	void render();
 
+	//! Fill in a RenderFrame with everything currently on screen.
+	/*!
+	The frame is a snapshot: it holds copies of positions and texture rectangles and shares the text and HUD
+	vertex lists, so it can be drawn on another thread while the game carries on.
+	\param frame the frame to fill in. Its previous contents are cleared.
+	*/
+	void buildFrame(RenderFrame& frame);
+
+	//! Change the renderer used by render().
+	/*!
+	The game does not take ownership of the renderer.
+	\param pRenderer the renderer, or NULL to go back to drawing to the window.
+	*/
+	void setRenderer(Renderer* pRenderer);
+
+	//! Check whether nothing but the background will change until the player presses a key.
+	/*!
+	This is the case when no GameObject is moving or animating, no text has changed and no alarms are pending,
+	e.g. on the scoreboard. The background's scroll is cosmetic and is ignored. main() uses this to draw fewer
+	frames while nothing else is happening.
+	*/
+	bool isIdle();
+
+	//! Get the job system used to spread the per-object update passes across threads.
+	JobSystem& getJobSystem();
+
+	//! A copy of everything that changes as the game is played, as taken by saveState().
+	class Snapshot;
+
+	//! Copy the game's state: its GameObjects, alarms, scores, stage, text, HUD and background.
+	/*!
+	Everything but the text is copied into one flat block of memory, which is reused when saving into the
+	same snapshot again. Text is only copied if it has changed since the snapshot was last saved into.
+	*/
+	void saveState(Snapshot& snapshot);
+
+	//! Put the game back the way it was when a snapshot was saved.
+	/*!
+	The GameObjects already in the game are overwritten in place, in list order, so only objects beyond the
+	number there are now have to be allocated. Objects left over are removed without objectDeleted() being called.
+	A snapshot can be restored into any game, not just the one it was saved from.
+	*/
+	void restoreState(const Snapshot& snapshot);
+
+	//! Write the game's state to a stream, in a form that can be saved to a file and read back by another game.
+	/*!
+	This covers everything saveState() does. Textures are not written; they are found again from the object types.
+	*/
+	void writeState(ByteWriter& out);
+
+	//! Replace the game's state with one written by writeState().
+	/*!
+	\return true if the state was read. If not, the game is left as it was.
+	*/
+	bool readState(ByteReader& in);
+
+	//! Copy the game's state into another game, which can then be played on from here on its own.
+	/*!
+	Nothing is loaded or allocated once the other game holds as many GameObjects as this one: textures are
+	not copied, as the other game has the same ones, and its objects are overwritten in place. To try many
+	futures from the same point, save a snapshot once and restore it into the other game before each.
+	The other game is also given this one's setFixedPoint() setting.
+	\param game the game to copy into. It must not be this game.
+	*/
+	void fork(ArcadeGame& game);
+
+	//! Get the current stage.
+	GameState getGameState() const;
+
+	//! Get the player's score.
+	int getScore() const;
+
+	//! Get the number of lives the player has left.
+	int getPlayerHealth() const;
+
+	//! Get the position of the player's ship.
+	/*!
+	\return the position, or (0, 0) while there is no ship, e.g. on the scoreboard.
+	*/
+	sf::Vector2f getPlayerPosition() const;
+
+	//! Find the GameObjects of a type nearest the player's ship, e.g. to describe the scene to an automated player.
+	/*!
+	\param type the type of object.
+	\param iMaxObjects the most objects to find.
+	\param pfOffsets filled with the offset of each object found from the ship, x then y, nearest first. It must
+	have room for 2 * iMaxObjects floats. Offsets are from (0, 0) while there is no ship.
+	\return the number of objects found.
+	*/
+	int findNearestObjects(ObjectTypes type, int iMaxObjects, float* pfOffsets);
+
+	//! Start a new game, as pressing R on the scoreboard does. The high scores are kept.
+	/*!
+	The game's starting state is saved the first time it is set up, which happens when the game is created,
+	and later restarts restore it rather than setting everything up again.
+	*/
+	void restartGame();
+
+	//! Get the time the last call to restartGame() took, in microseconds.
+	sf::Int64 getRestartTime() const;
+
+	//! The hash of one GameObject, as found by hashState().
+	class ObjectHash
+	{
+	public:
+		const char* sType;
+		sf::Uint64 iHash;
+		sf::Vector2f position;
+	};
+
+	//! Hash everything that decides how the game plays on, to check that two runs of it are still identical.
+	/*!
+	The hash is worked out from scratch on every call, not kept up to date as objects spawn, move and die, so
+	it costs a pass over every GameObject and is only worth calling on ticks that are checked. Each GameObject is hashed on its own, in parallel, and the results are added together with the hash of
+	the game's other state. An object appearing or disappearing therefore changes the total by its own hash
+	alone, and the objects that differ between two runs can be found from getObjectHashes(). Floats are
+	hashed by their exact bits. Text and the HUD are left out, as they only show state that is hashed already.
+	*/
+	sf::Uint64 hashState();
+
+	//! Get the hash of each GameObject, in list order, as found by the last call to hashState().
+	const std::vector<ObjectHash>& getObjectHashes() const;
+
+	//! How long the last call to buildRunAheadFrame() spent on each step, in microseconds.
+	class RunAheadCost
+	{
+	public:
+		sf::Int64 iSaveTime;
+		sf::Int64 iSimulateTime;
+		sf::Int64 iRestoreTime;
+	};
+
+	//! Fill in a RenderFrame with the game as it will be a number of ticks from now, then put the game back.
+	/*!
+	The extra ticks are run with the keys currently held, but without repeating any presses or releases.
+	Showing the frame hides the tick or two a key press takes to show up on screen, in the same way as an
+	emulator's run-ahead. Those ticks are thrown away, and the game carries on from its real state.
+	\param input the input of the tick just run.
+	\param iTicks the number of ticks to run ahead.
+	\param frame the frame to fill in.
+	*/
+	void buildRunAheadFrame(const InputState& input, int iTicks, RenderFrame& frame);
+
+	//! Get the time taken by the last call to buildRunAheadFrame().
+	const RunAheadCost& getRunAheadCost() const;
+
+	//! Tell the game how much work to shed, as decided by a FrameGovernor.
+	/*!
+	From NO_COSMETICS the background stops scrolling, animations stop stepping and changed text is only laid
+	out every few frames. From CAPPED_SPAWNS comets and saucers are spawned less often. Rendering every other
+	frame is up to the caller.
+	*/
+	void setLoadLevel(FrameGovernor::Level level);
+
+	//! Get the level set by setLoadLevel().
+	FrameGovernor::Level getLoadLevel() const;
+
+	//! Choose whether GameObjects are moved in fixed point, so that the game plays out the same in every build.
+	/*!
+	Objects move and follow the saucers' wave in FixedPoint arithmetic, and positions only ever hold values a
+	float holds exactly, so keeping objects on screen is exact too. Floats remain for the inputs the game is
+	given and for drawing. Games moved in fixed point play out slightly differently from ones moved with floats, so a
+	recording must be played back with the setting it was made with. The default is floats.
+	*/
+	void setFixedPoint(bool bFixedPoint);
+
+	//! Check whether GameObjects are moved in fixed point.
+	bool isFixedPoint() const;
+
 private:
 	/* Private constants */
 	static const int s_kiINTRO_STAGE_DURATION = 5;
@@ -31,10 +246,12 @@ private:
 	static const int s_kiSAUCER_STAGE_DURATION = 30;
 	static const int s_kiCOMET_STAGE_DURATION = 30;
 	static const int s_kiREVIVE_IMMUNITY_DURATION = 3;
+	static const int s_kiTICKS_PER_SECOND = 30;
 	static const int s_kiPOINTS_PER_SECOND = 20;
 	static const int s_kiPOINTS_PER_SAUCER_KILL = 20;
 	static const int s_kiMAX_COMETS = 10;
 	static const int s_kiMAX_SAUCERS = 12;
+	static const int s_kiBOSS_WAVE_SIZE = 9;
 	
 	static const int s_kiSAUCER_SPEED = 100;
 	static const int s_kiCOMET_SPEED = 150;
@@ -42,11 +259,123 @@ private:
 
 	static const int s_kiNUM_SCORES_STORED = 8;
 
+	static const int s_kiBACKGROUND_SCROLL_SPEED = 100;
+
+	static const int s_kiNUM_BOSS_FRAMES = 5;
+	static const int s_kiBOSS_FRAME_WIDTH = 75;
+
+	static const int s_kiLOADED_TEXT_LAYOUT_INTERVAL = 10;
+	static const int s_kiLOADED_SPAWN_INTERVAL_SCALE = 2;
+
+	static const int s_kiTITLE_FONT_SIZE = 50;
+	static const int s_kiSCOREBOARD_FONT_SIZE = 30;
+
 	static enum Flags {CAN_MOVE_LEFT, CAN_MOVE_RIGHT, CAN_MOVE_UP, CAN_MOVE_DOWN, CAN_SHOOT, CAN_TAKE_DAMAGE};
 	static enum Alarms {SHOT_FIRED, INTRO_STAGE_DURATION, INTERVAL_STAGE_DURATION, COMET_STAGE_DURATION, 
 						SAUCER_STAGE_DURATION, REVIVE_IMMUNITY, SPAWN_COMET, SPAWN_SAUCER, BOSS_VULNERABILITY, 
-						BOSS_ATTACK, BOSS_DEATH};
+						BOSS_ATTACK, BOSS_DEATH, NUM_ALARMS};
+
+public:
+	/* Defined down here, as it needs the private constants. */
+	class Snapshot
+	{
+	private:
+		friend class ArcadeGame;
 
+		/* Everything but the objects and the background. */
+		class Fields
+		{
+		public:
+			int iNumObjects;
+			/* The index of the ship among the objects, or -1. */
+			int iShip;
+			int iNumBackgroundValues;
+
+			bool bCanMoveUp;
+			bool bCanMoveLeft;
+			bool bCanMoveDown;
+			bool bCanMoveRight;
+			bool bCanShoot;
+			bool bCanTakeDamage;
+
+			int aiScores[s_kiNUM_SCORES_STORED];
+			bool abAlarmActive[NUM_ALARMS];
+			float afAlarmTimeRemaining[NUM_ALARMS];
+			int iTick;
+			int iGameStartTick;
+			float fDifficulty;
+			int iNumSaucers;
+			int iNumComets;
+
+			int iPlayerHealth;
+			int iScore;
+			int iBossHealth;
+			bool bBossIsVulnerable;
+
+			Random::State random;
+			GameState gameState;
+			GameState previousGameState;
+			int iHealthCounter;
+		};
+
+		/* One GameObject. The type and texture are indices rather than a string and a pointer, so the record */
+		/* can be copied as it is and put back into any game. */
+		class ObjectState
+		{
+		public:
+			sf::Vector2f position;
+			sf::Vector2f velocity;
+			float fSpeedPerMicrosecond;
+			sf::IntRect aliveZone;
+			int iFrame;
+			sf::Uint8 iType;
+			sf::Uint8 iTextureFrame;
+			bool bSolid;
+			bool bStayOnScreen;
+			bool bAutoUpdatePosition;
+		};
+
+		Fields& getFields();
+		const Fields& getFields() const;
+		ObjectState* getObjects();
+		const ObjectState* getObjects() const;
+		float* getBackground();
+		const float* getBackground() const;
+
+		/* The Fields, then an ObjectState for each GameObject in list order, then the background's values. */
+		/* Its memory is reused every time the snapshot is saved into. */
+		std::vector<char> vData;
+		/* Text is kept apart, as it only needs copying when it has changed. */
+		TextLayer::State text;
+	};
+
+	class Assets
+	{
+	public:
+		//! Assets constructor. Nothing is loaded until load() is called.
+		Assets();
+
+		//! Load the textures and font from the images folder.
+		/*!
+		\return true if everything was loaded.
+		*/
+		bool load();
+
+	private:
+		friend class ArcadeGame;
+
+		/* The texture of each of the ObjectTypes. The boss's is left empty, as it has one for each frame. */
+		sf::Texture aObjectTextures[NUM_OBJECT_TYPES];
+		sf::Texture aBossTextures[s_kiNUM_BOSS_FRAMES];
+		sf::Texture background;
+		bool bHasBackground;
+		GlyphAtlas font;
+
+		Assets(const Assets&);
+		Assets& operator=(const Assets&);
+	};
+
+private:
 	/* Private variables */
 	bool m_bCanMoveUp;
 	bool m_bCanMoveLeft;
@@ -55,9 +384,12 @@ private:
 	bool m_bCanShoot;
 	bool m_bCanTakeDamage;
 
-	int m_aiScores[8];
-	std::map<int, bool> m_ActiveAlarms;
-	time_t m_GameStartTime;
+	int m_aiScores[s_kiNUM_SCORES_STORED];
+	bool m_abAlarmActive[NUM_ALARMS];
+	float m_afAlarmTimeRemaining[NUM_ALARMS];
+	/* The number of ticks run, which is the game's clock. */
+	int m_iTick;
+	int m_iGameStartTick;
 	float m_fDifficulty;
 	int m_iNumSaucers;
 	int m_iNumComets;
@@ -67,12 +399,71 @@ private:
 	int m_iBossHealth;
 	bool m_bBossIsVulnerable;
 
+	Random m_Random;
+
 	GameObject* m_pShip;
 	GameState m_GameState;
 	GameState m_PreviousGameState;
 
+	TextLayer m_TextLayer;
+	TextLayer::TextHandle m_TitleText;
+	TextLayer::TextHandle m_RoundScoreText;
+	TextLayer::TextHandle m_HighscoresText;
+	TextLayer::TextHandle m_aScoreTexts[s_kiNUM_SCORES_STORED];
+	TextLayer::TextHandle m_RestartText;
+
+	ParallaxBackground m_Background;
+	HudLayer m_Hud;
+	HudLayer::CounterHandle m_HealthCounter;
+
+	/* The assets the game loaded itself, if it was not given any to share. */
+	std::unique_ptr<Assets> m_pOwnAssets;
+	const Assets* m_pAssets;
+
+	JobSystem m_Jobs;
+	std::vector<GameObject*> m_vObjects;
+	/* The objects destroyed by the commands being applied, sorted once they have all been gathered. */
+	std::vector<GameObject*> m_vpDestroyed;
+	std::vector<ObjectHash> m_vObjectHashes;
+	std::vector<float> m_vfHashedBackground;
+	/* The squared distance of each object found so far by findNearestObjects(), nearest first. */
+	std::vector<float> m_vfNearestDistances;
+	bool m_bFixedPoint;
+	/* Each object's position and movement for the tick, in fixed point, while objects are being moved. */
+	std::vector<sf::Int32> m_viFixedX;
+	std::vector<sf::Int32> m_viFixedY;
+	std::vector<sf::Int32> m_viFixedStepX;
+	std::vector<sf::Int32> m_viFixedStepY;
+	CollisionDetector m_CollisionDetector;
+	std::vector<CollisionDetector::Hit> m_vCollisions;
+	/* Changes recorded by jobs on the JobSystem threads, applied by applyCommands(). */
+	CommandBuffer m_Commands;
+	/* Incremented whenever the game removes objects itself, which invalidates any list of objects taken earlier. */
+	int m_iSceneGeneration;
+
+	Snapshot m_RunAheadSnapshot;
+	Snapshot m_ForkSnapshot;
+	/* The state a new game starts in, restored by every restart after the first. */
+	Snapshot m_RestartSnapshot;
+	bool m_bHasRestartSnapshot;
+	sf::Int64 m_iRestartTime;
+	/* The texture of each of the ObjectTypes, which for the boss is its first frame, and of each boss frame. */
+	sf::Texture* m_apObjectTextures[NUM_OBJECT_TYPES];
+	sf::Texture* m_apBossTextures[s_kiNUM_BOSS_FRAMES];
+	/* A GameObject of each type, copied over objects that restoreState() reuses for a different type. */
+	std::vector<GameObject> m_vPrototypes;
+	RunAheadCost m_RunAheadCost;
+
+	FrameGovernor::Level m_LoadLevel;
+	int m_iFramesSinceTextLayout;
+
+	RenderFrame m_Frame;
+	WindowRenderer m_WindowRenderer;
+	Renderer* m_pRenderer;
+
 	/* Private functions */
-	void restartGame();
+	void initialise();
+	void removeAllGameObjects();
 	void changeGameState(ArcadeGame::GameState newGameState);
 	void killGameObject(GameObject* pGO);
 	bool collisionWasBetween(GameObject* pGO1, GameObject* pGO2, std::string sGOType1, std::string sGOType2);
@@ -85,27 +476,43 @@ private:
 	void spawnComet();
 	void spawnBullet();
 	void spawnBoss();
-	void spawnBossBullet(int iXOffset, int iYPosition);
-	void spawnHealthIndicator(int iIndex);
+	GameObject* createBossBullet(int iXOffset, int iYPosition) const;
 	void bossAttack();
 	void revivePlayer();
 	bool hasHealthRemaining(std::string sUnit);
 	void endGame();
 	void initialiseStage();
 	void finishStage();
+	void updateWorld(float fSeconds);
+	void updateObjects(float fSeconds);
+	void applyCommands();
+	void checkCollisions();
 	void createAlarm(Alarms alarm, float fAlarmTime);
+	void checkAlarms(float fSeconds);
+	void cancelAllAlarms();
 	bool alarmIsActive(Alarms alarm);
 	void removeAlarm(Alarms alarm);
 	GameObject* selectGOType(std::string sGOType, GameObject* pGO1, GameObject* pGO2);
 	void commitScore();
+	void createText();
+	void showScoreboard(bool bVisible);
 	void bubbleSortScores();
 	float getElapsedTime();
 	void animateBoss();
+	float getSpawnIntervalScale();
+	sf::Texture* getObjectTexture(int iType, int iTextureFrame);
+	void identifyObject(const GameObject* pGO, int& iType, int& iTextureFrame);
+	void saveObject(GameObject* pGO, Snapshot::ObjectState& object);
+	static sf::Uint64 hashObject(const Snapshot::ObjectState& object);
+	void restoreObject(const Snapshot::ObjectState& object, GameObject* pGO);
+	void writeSnapshot(const Snapshot& snapshot, ByteWriter& out);
+	bool readSnapshot(ByteReader& in, Snapshot& snapshot);
 
 	/* General utility functions */
 	int getRandom(int iMaxValue);
 	std::string convertIntToString(int iNumber);
 	bool isBetween(int iLower, int iUpper, int iValue);
+	float getSign(float fValue);
 	int lowestValue(int aiValues[], int iArraySize);
 };
 
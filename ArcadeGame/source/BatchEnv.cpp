@@ -0,0 +1,163 @@
+#include "BatchEnv.h"
+
+/* The object type each of the Nearby kinds looks for. */
+static const ArcadeGame::ObjectTypes s_kaNEARBY_TYPES[] = {ArcadeGame::OBJECT_COMET, ArcadeGame::OBJECT_SAUCER,
+														   ArcadeGame::OBJECT_BULLET, ArcadeGame::OBJECT_BOSS_BULLET};
+
+/* Constructor */
+BatchEnv::BatchEnv(int iNumWorkers) : m_Pool(iNumWorkers)
+{
+	m_iNumSteps = 0;
+	m_iStepTime = 0;
+}
+
+/* Every array is sized once here, so stepping never allocates and pointers handed out stay valid. */
+bool BatchEnv::create(int iNumSlots, sf::Uint64 iFirstSeed)
+{
+	bool bLoaded = m_Pool.create(iNumSlots, iFirstSeed);
+
+	m_vInputs.assign(iNumSlots, InputState());
+	m_viPreviousKeys.assign(iNumSlots, 0);
+	m_vfPlayerPositions.assign(2 * iNumSlots, 0);
+	m_viPlayerHealth.assign(iNumSlots, 0);
+	m_viScores.assign(iNumSlots, 0);
+	m_viGameStates.assign(iNumSlots, 0);
+	for (int i = 0; i < NUM_NEARBY; i++)
+	{
+		m_avfNearest[i].assign(2 * s_kiNUM_NEAREST * iNumSlots, 0);
+		m_aviNumNearest[i].assign(iNumSlots, 0);
+	}
+	m_viResets.assign(iNumSlots, 0);
+	m_viFinalScores.assign(iNumSlots, 0);
+
+	m_Pool.forEachSession([this](int iSlot, ArcadeGame& game)
+	{
+		observe(iSlot, game);
+	});
+	resetStats();
+	return bLoaded;
+}
+
+int BatchEnv::getNumSlots() const
+{
+	return m_Pool.getNumSessions();
+}
+
+ArcadeGame& BatchEnv::getGame(int iSlot)
+{
+	return m_Pool.getSession(iSlot);
+}
+
+/* Each slot is stepped, restarted if need be and observed in one go, so its game is only touched by one thread */
+/* while it is still in that thread's cache. */
+void BatchEnv::step(const sf::Uint16* piKeys)
+{
+	sf::Clock clock;
+	m_Pool.forEachSession([this, piKeys](int iSlot, ArcadeGame& game)
+	{
+		InputState::Frame frame;
+		frame.iHeld = piKeys[iSlot];
+		frame.iPressed = static_cast<sf::Uint16>(piKeys[iSlot] & ~m_viPreviousKeys[iSlot]);
+		frame.iReleased = static_cast<sf::Uint16>(m_viPreviousKeys[iSlot] & ~piKeys[iSlot]);
+		for (int i = 0; i < InputState::NUM_KEYS; i++)
+		{
+			frame.aiHeldFraction[i] = (frame.iHeld & (1 << i)) ? 255 : 0;
+		}
+		m_vInputs[iSlot].setFrame(frame);
+		m_viPreviousKeys[iSlot] = piKeys[iSlot];
+
+		game.gameMain(m_vInputs[iSlot]);
+
+		m_viResets[iSlot] = 0;
+		if (game.getGameState() == ArcadeGame::SCOREBOARD)
+		{
+			m_viFinalScores[iSlot] = game.getScore();
+			m_viResets[iSlot] = 1;
+			game.restartGame();
+			/* The new episode starts with no keys down, so a key still held is pressed again on its first step. */
+			m_viPreviousKeys[iSlot] = 0;
+		}
+		observe(iSlot, game);
+	});
+	m_iStepTime += clock.getElapsedTime().asMicroseconds();
+	m_iNumSteps += getNumSlots();
+}
+
+/* Writes a slot's part of every observation array. */
+void BatchEnv::observe(int iSlot, ArcadeGame& game)
+{
+	sf::Vector2f position = game.getPlayerPosition();
+	m_vfPlayerPositions[2 * iSlot] = position.x;
+	m_vfPlayerPositions[2 * iSlot + 1] = position.y;
+	m_viPlayerHealth[iSlot] = game.getPlayerHealth();
+	m_viScores[iSlot] = game.getScore();
+	m_viGameStates[iSlot] = game.getGameState();
+
+	for (int i = 0; i < NUM_NEARBY; i++)
+	{
+		float* pfNearest = &m_avfNearest[i][2 * s_kiNUM_NEAREST * iSlot];
+		int iNumFound = game.findNearestObjects(s_kaNEARBY_TYPES[i], s_kiNUM_NEAREST, pfNearest);
+		for (int j = 2 * iNumFound; j < 2 * s_kiNUM_NEAREST; j++)
+		{
+			pfNearest[j] = 0;
+		}
+		m_aviNumNearest[i][iSlot] = iNumFound;
+	}
+}
+
+const float* BatchEnv::getPlayerPositions() const
+{
+	return m_vfPlayerPositions.empty() ? NULL : &m_vfPlayerPositions[0];
+}
+
+const int* BatchEnv::getPlayerHealth() const
+{
+	return m_viPlayerHealth.empty() ? NULL : &m_viPlayerHealth[0];
+}
+
+const int* BatchEnv::getScores() const
+{
+	return m_viScores.empty() ? NULL : &m_viScores[0];
+}
+
+const int* BatchEnv::getGameStates() const
+{
+	return m_viGameStates.empty() ? NULL : &m_viGameStates[0];
+}
+
+const float* BatchEnv::getNearest(Nearby nearby) const
+{
+	return m_avfNearest[nearby].empty() ? NULL : &m_avfNearest[nearby][0];
+}
+
+const int* BatchEnv::getNumNearest(Nearby nearby) const
+{
+	return m_aviNumNearest[nearby].empty() ? NULL : &m_aviNumNearest[nearby][0];
+}
+
+const sf::Uint8* BatchEnv::getResets() const
+{
+	return m_viResets.empty() ? NULL : &m_viResets[0];
+}
+
+const int* BatchEnv::getFinalScores() const
+{
+	return m_viFinalScores.empty() ? NULL : &m_viFinalScores[0];
+}
+
+/* Counts the time steps took from start to finish, so the figure is for the batch across every thread at once. */
+double BatchEnv::getStepsPerSecond() const
+{
+	return m_iStepTime > 0 ? m_iNumSteps * 1000000.0 / m_iStepTime : 0;
+}
+
+sf::Int64 BatchEnv::getNumSteps() const
+{
+	return m_iNumSteps;
+}
+
+void BatchEnv::resetStats()
+{
+	m_iNumSteps = 0;
+	m_iStepTime = 0;
+}
@@ -0,0 +1,119 @@
+#ifndef BATCH_ENV_H
+#define BATCH_ENV_H
+
+#include "SessionPool.h"
+#include <vector>
+
+//! The BatchEnv class
+
+/*!
+Steps a batch of games together, for training and testing automated players. Each game is a slot, given the
+keys to hold for every tick as one number, and described after every tick by a fixed set of numbers: where the
+ship is, its lives, the score, the stage, and where the comets, saucers and bullets nearest the ship are.
+
+Observations are kept as one array per value, holding that value for every slot in slot order, and each slot
+writes its own part of the arrays straight after its tick, on whichever thread ran it. The getters return the
+arrays themselves, so a batch can be read, or handed to another library, without anything being copied. They
+stay valid until the next call to create(), and are overwritten by each step().
+
+A slot whose game ends is restarted at the end of the tick it ended in, so every slot always holds a game in
+play. getResets() shows which slots were restarted, and getFinalScores() what their games scored.
+*/
+class BatchEnv
+{
+public:
+	//! The number of objects of each kind described for each slot.
+	static const int s_kiNUM_NEAREST = 4;
+
+	//! The kinds of object whose nearest few are described.
+	enum Nearby {NEARBY_COMETS, NEARBY_SAUCERS, NEARBY_BULLETS, NEARBY_BOSS_BULLETS, NUM_NEARBY};
+
+	//! BatchEnv constructor. There are no slots until create() is called.
+	/*!
+	\param iNumWorkers the number of worker threads to step slots on, as for JobSystem.
+	*/
+	BatchEnv(int iNumWorkers = -1);
+
+	//! Create a number of slots, each with a new game, and fill in their first observations.
+	/*!
+	\param iNumSlots the number of slots.
+	\param iFirstSeed the seed of the first slot's game. Each slot after it gets the next seed.
+	\return true if the assets were loaded.
+	*/
+	bool create(int iNumSlots, sf::Uint64 iFirstSeed);
+
+	//! Get the number of slots.
+	int getNumSlots() const;
+
+	//! Get the game in a slot, e.g. to record or draw it.
+	ArcadeGame& getGame(int iSlot);
+
+	//! Run one tick of every slot and fill in the observations.
+	/*!
+	\param piKeys the keys held in each slot for the tick, one bit per InputState::Key, as in
+	InputState::Frame::iHeld. A key held now but not in the slot's last tick counts as pressed.
+	*/
+	void step(const sf::Uint16* piKeys);
+
+	//! Get the position of each slot's ship: x then y for each slot, or (0, 0) where there is no ship.
+	const float* getPlayerPositions() const;
+
+	//! Get the number of lives left in each slot.
+	const int* getPlayerHealth() const;
+
+	//! Get the score of each slot.
+	const int* getScores() const;
+
+	//! Get the stage of each slot, as an ArcadeGame::GameState.
+	const int* getGameStates() const;
+
+	//! Get the offsets from each slot's ship of the nearest objects of a kind.
+	/*!
+	\return s_kiNUM_NEAREST offsets for each slot, each x then y, nearest first. Offsets beyond the number
+	found are 0.
+	*/
+	const float* getNearest(Nearby nearby) const;
+
+	//! Get the number of objects of a kind found for each slot, up to s_kiNUM_NEAREST.
+	const int* getNumNearest(Nearby nearby) const;
+
+	//! Get whether each slot's game ended in the last step and was restarted: 1 if it was, 0 if not.
+	const sf::Uint8* getResets() const;
+
+	//! Get the score each slot's game ended with, for the slots getResets() shows were restarted.
+	const int* getFinalScores() const;
+
+	//! Get the number of slot ticks run per second, over every step since create() or resetStats().
+	double getStepsPerSecond() const;
+
+	//! Get the number of slot ticks run since create() or resetStats().
+	sf::Int64 getNumSteps() const;
+
+	//! Start counting steps and their time again.
+	void resetStats();
+
+private:
+	void observe(int iSlot, ArcadeGame& game);
+
+	SessionPool m_Pool;
+
+	std::vector<InputState> m_vInputs;
+	std::vector<sf::Uint16> m_viPreviousKeys;
+
+	std::vector<float> m_vfPlayerPositions;
+	std::vector<int> m_viPlayerHealth;
+	std::vector<int> m_viScores;
+	std::vector<int> m_viGameStates;
+	std::vector<float> m_avfNearest[NUM_NEARBY];
+	std::vector<int> m_aviNumNearest[NUM_NEARBY];
+	std::vector<sf::Uint8> m_viResets;
+	std::vector<int> m_viFinalScores;
+
+	sf::Int64 m_iNumSteps;
+	sf::Int64 m_iStepTime;
+
+	BatchEnv(const BatchEnv&);
+	BatchEnv& operator=(const BatchEnv&);
+};
+
+#endif
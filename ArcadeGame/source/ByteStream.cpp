@@ -0,0 +1,186 @@
+#include "ByteStream.h"
+#include <cstring>
+
+/* Constructor */
+ByteWriter::ByteWriter(std::vector<char>& vBuffer) : m_vBuffer(vBuffer)
+{
+}
+
+void ByteWriter::writeUint8(sf::Uint8 iValue)
+{
+	m_vBuffer.push_back(static_cast<char>(iValue));
+}
+
+void ByteWriter::writeUint16(sf::Uint16 iValue)
+{
+	writeUint8(static_cast<sf::Uint8>(iValue));
+	writeUint8(static_cast<sf::Uint8>(iValue >> 8));
+}
+
+void ByteWriter::writeUint32(sf::Uint32 iValue)
+{
+	writeUint16(static_cast<sf::Uint16>(iValue));
+	writeUint16(static_cast<sf::Uint16>(iValue >> 16));
+}
+
+void ByteWriter::writeUint64(sf::Uint64 iValue)
+{
+	writeUint32(static_cast<sf::Uint32>(iValue));
+	writeUint32(static_cast<sf::Uint32>(iValue >> 32));
+}
+
+void ByteWriter::writeInt32(sf::Int32 iValue)
+{
+	writeUint32(static_cast<sf::Uint32>(iValue));
+}
+
+void ByteWriter::writeFloat(float fValue)
+{
+	sf::Uint32 iBits;
+	memcpy(&iBits, &fValue, sizeof(iBits));
+	writeUint32(iBits);
+}
+
+void ByteWriter::writeBool(bool bValue)
+{
+	writeUint8(bValue ? 1 : 0);
+}
+
+/* Seven bits per byte, lowest first, with the top bit set on every byte but the last. */
+void ByteWriter::writeVarint(sf::Uint64 iValue)
+{
+	while (iValue >= 0x80)
+	{
+		writeUint8(static_cast<sf::Uint8>(iValue | 0x80));
+		iValue >>= 7;
+	}
+	writeUint8(static_cast<sf::Uint8>(iValue));
+}
+
+void ByteWriter::writeString(const std::string& sString)
+{
+	writeVarint(sString.size());
+	writeBytes(sString.data(), sString.size());
+}
+
+void ByteWriter::writeBytes(const char* pData, std::size_t iSize)
+{
+	m_vBuffer.insert(m_vBuffer.end(), pData, pData + iSize);
+}
+
+std::size_t ByteWriter::getSize() const
+{
+	return m_vBuffer.size();
+}
+
+/* Constructor */
+ByteReader::ByteReader(const char* pData, std::size_t iSize)
+{
+	m_pData = pData;
+	m_iSize = iSize;
+	m_iPosition = 0;
+	m_bValid = true;
+}
+
+sf::Uint8 ByteReader::readUint8()
+{
+	if (m_iPosition >= m_iSize)
+	{
+		m_bValid = false;
+		return 0;
+	}
+	return static_cast<sf::Uint8>(m_pData[m_iPosition++]);
+}
+
+sf::Uint16 ByteReader::readUint16()
+{
+	sf::Uint16 iLow = readUint8();
+	return static_cast<sf::Uint16>(iLow | (readUint8() << 8));
+}
+
+sf::Uint32 ByteReader::readUint32()
+{
+	sf::Uint32 iLow = readUint16();
+	return iLow | (static_cast<sf::Uint32>(readUint16()) << 16);
+}
+
+sf::Uint64 ByteReader::readUint64()
+{
+	sf::Uint64 iLow = readUint32();
+	return iLow | (static_cast<sf::Uint64>(readUint32()) << 32);
+}
+
+sf::Int32 ByteReader::readInt32()
+{
+	return static_cast<sf::Int32>(readUint32());
+}
+
+float ByteReader::readFloat()
+{
+	sf::Uint32 iBits = readUint32();
+	float fValue;
+	memcpy(&fValue, &iBits, sizeof(fValue));
+	return fValue;
+}
+
+bool ByteReader::readBool()
+{
+	return readUint8() != 0;
+}
+
+/* A varint longer than a 64-bit value can be is treated as corrupt. */
+sf::Uint64 ByteReader::readVarint()
+{
+	sf::Uint64 iValue = 0;
+	for (int iShift = 0; iShift < 64; iShift += 7)
+	{
+		sf::Uint8 iByte = readUint8();
+		iValue |= static_cast<sf::Uint64>(iByte & 0x7F) << iShift;
+		if ((iByte & 0x80) == 0)
+		{
+			return iValue;
+		}
+	}
+	m_bValid = false;
+	return 0;
+}
+
+std::string ByteReader::readString()
+{
+	sf::Uint64 iLength = readVarint();
+	const char* pChars = readBytes(static_cast<std::size_t>(iLength));
+	return pChars ? std::string(pChars, static_cast<std::size_t>(iLength)) : std::string();
+}
+
+const char* ByteReader::readBytes(std::size_t iSize)
+{
+	if (iSize > m_iSize - m_iPosition)
+	{
+		m_bValid = false;
+		m_iPosition = m_iSize;
+		return NULL;
+	}
+	const char* pBytes = m_pData + m_iPosition;
+	m_iPosition += iSize;
+	return pBytes;
+}
+
+bool ByteReader::isValid() const
+{
+	return m_bValid;
+}
+
+bool ByteReader::isAtEnd() const
+{
+	return m_iPosition >= m_iSize;
+}
+
+std::size_t ByteReader::getPosition() const
+{
+	return m_iPosition;
+}
+
+std::size_t ByteReader::getRemaining() const
+{
+	return m_iSize - m_iPosition;
+}
@@ -0,0 +1,102 @@
+#ifndef BYTE_STREAM_H
+#define BYTE_STREAM_H
+
+#include "SFML/Config.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+//! The ByteWriter class
+
+/*!
+Writes values to the end of a byte buffer in a fixed little-endian layout, so that what is written on one
+machine reads back the same on another. Floats are written as their exact bits. Varints take one byte for
+values below 128 and one more for every further 7 bits, which suits counts and small changes.
+*/
+class ByteWriter
+{
+public:
+	//! ByteWriter constructor.
+	/*!
+	\param vBuffer the buffer to append to. The writer does not clear it.
+	*/
+	ByteWriter(std::vector<char>& vBuffer);
+
+	void writeUint8(sf::Uint8 iValue);
+	void writeUint16(sf::Uint16 iValue);
+	void writeUint32(sf::Uint32 iValue);
+	void writeUint64(sf::Uint64 iValue);
+	void writeInt32(sf::Int32 iValue);
+	void writeFloat(float fValue);
+	void writeBool(bool bValue);
+	void writeVarint(sf::Uint64 iValue);
+
+	//! Write a string as its length (a varint) followed by its characters.
+	void writeString(const std::string& sString);
+
+	//! Write raw bytes.
+	void writeBytes(const char* pData, std::size_t iSize);
+
+	//! Get the number of bytes in the buffer, i.e. the offset the next value will be written at.
+	std::size_t getSize() const;
+
+private:
+	std::vector<char>& m_vBuffer;
+
+	ByteWriter(const ByteWriter&);
+	ByteWriter& operator=(const ByteWriter&);
+};
+
+//! The ByteReader class
+
+/*!
+Reads values written by a ByteWriter from a block of memory, without copying it. Reading past the end
+does not crash: it returns zeros and marks the reader as failed, so a whole record can be read and
+checked once with isValid().
+*/
+class ByteReader
+{
+public:
+	//! ByteReader constructor.
+	/*!
+	\param pData the first byte to read. The memory must outlive the reader.
+	\param iSize the number of bytes that may be read.
+	*/
+	ByteReader(const char* pData, std::size_t iSize);
+
+	sf::Uint8 readUint8();
+	sf::Uint16 readUint16();
+	sf::Uint32 readUint32();
+	sf::Uint64 readUint64();
+	sf::Int32 readInt32();
+	float readFloat();
+	bool readBool();
+	sf::Uint64 readVarint();
+	std::string readString();
+
+	//! Get a pointer to the next iSize bytes and skip over them.
+	/*!
+	\return the bytes, or NULL if there are not that many left.
+	*/
+	const char* readBytes(std::size_t iSize);
+
+	//! Check that nothing has been read past the end.
+	bool isValid() const;
+
+	//! Check whether every byte has been read.
+	bool isAtEnd() const;
+
+	//! Get the offset of the next byte to be read.
+	std::size_t getPosition() const;
+
+	//! Get the number of bytes left to read.
+	std::size_t getRemaining() const;
+
+private:
+	const char* m_pData;
+	std::size_t m_iSize;
+	std::size_t m_iPosition;
+	bool m_bValid;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "CollisionDetector.h"
+#include <algorithm>
+
+/* Constructor */
+CollisionDetector::CollisionDetector()
+{
+	m_iNumCandidates = 0;
+}
+
+/* Objects are only compared if they are solid and of different types. Types are turned into small integers */
+/* up front, so that comparing them in the inner loop does not mean comparing (and copying) strings. */
+void CollisionDetector::findCollisions(const std::vector<GameObject*>& vObjects, JobSystem& jobs, std::vector<Hit>& vHits)
+{
+	m_vEntries.clear();
+	for (unsigned int i = 0; i < vObjects.size(); i++)
+	{
+		if (vObjects[i]->getSolid())
+		{
+			Entry entry;
+			entry.iIndex = static_cast<int>(i);
+			entry.iType = getTypeId(vObjects[i]->getObjectType());
+			entry.bounds = vObjects[i]->getGlobalBounds();
+			m_vEntries.push_back(entry);
+		}
+	}
+	std::sort(m_vEntries.begin(), m_vEntries.end());
+
+	m_vThreadHits.resize(jobs.getNumThreads());
+	m_viThreadCandidates.assign(jobs.getNumThreads(), 0);
+	for (unsigned int i = 0; i < m_vThreadHits.size(); i++)
+	{
+		m_vThreadHits[i].clear();
+	}
+
+	/* Each entry is compared with the entries after it that start before it ends. */
+	const std::vector<Entry>& vEntries = m_vEntries;
+	std::vector<std::vector<Hit> >& vThreadHits = m_vThreadHits;
+	std::vector<int>& viThreadCandidates = m_viThreadCandidates;
+	jobs.parallelForWithThreadIndex(0, static_cast<int>(vEntries.size()), s_kiGRAIN_SIZE,
+		[&vEntries, &vThreadHits, &viThreadCandidates](int iThread, int iBegin, int iEnd)
+	{
+		std::vector<Hit>& vThreadHit = vThreadHits[iThread];
+		int iNumCandidates = 0;
+		for (int a = iBegin; a < iEnd; a++)
+		{
+			const Entry& first = vEntries[a];
+			float fRight = first.bounds.left + first.bounds.width;
+			for (unsigned int b = a + 1; b < vEntries.size() && vEntries[b].bounds.left < fRight; b++)
+			{
+				const Entry& second = vEntries[b];
+				iNumCandidates++;
+				if (first.iType != second.iType && first.bounds.intersects(second.bounds))
+				{
+					vThreadHit.push_back(Hit(std::min(first.iIndex, second.iIndex), std::max(first.iIndex, second.iIndex)));
+				}
+			}
+		}
+		viThreadCandidates[iThread] += iNumCandidates;
+	});
+
+	vHits.clear();
+	m_iNumCandidates = 0;
+	for (unsigned int i = 0; i < m_vThreadHits.size(); i++)
+	{
+		vHits.insert(vHits.end(), m_vThreadHits[i].begin(), m_vThreadHits[i].end());
+		m_iNumCandidates += m_viThreadCandidates[i];
+	}
+	std::sort(vHits.begin(), vHits.end());
+}
+
+int CollisionDetector::getNumCandidates() const
+{
+	return m_iNumCandidates;
+}
+
+/* There are only a handful of object types, so a linear search is quicker than a map. */
+int CollisionDetector::getTypeId(const std::string& sType)
+{
+	for (unsigned int i = 0; i < m_vTypes.size(); i++)
+	{
+		if (m_vTypes[i] == sType)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	m_vTypes.push_back(sType);
+	return static_cast<int>(m_vTypes.size() - 1);
+}
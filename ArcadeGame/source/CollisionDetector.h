@@ -0,0 +1,66 @@
+#ifndef COLLISION_DETECTOR_H
+#define COLLISION_DETECTOR_H
+
+#include "GameObject.h"
+#include "JobSystem.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+//! The CollisionDetector class
+
+/*!
+Finds every pair of solid GameObjects of different types whose bounds overlap, using the same rules as
+BaseArcade. The broadphase sorts the objects by their left edge and sweeps across them, so only objects
+that overlap horizontally become candidate pairs. The narrowphase tests the candidates on all threads of
+a JobSystem, each thread writing its hits into a buffer of its own.
+
+The hits are then merged and sorted by the objects' indices, i.e. the order they were added to the game,
+so the result is identical however many threads there are and however the work was split between them.
+*/
+class CollisionDetector
+{
+public:
+	//! A pair of colliding objects, given as indices into the list passed to findCollisions(). The first index is the lower.
+	typedef std::pair<int, int> Hit;
+
+	//! CollisionDetector constructor.
+	CollisionDetector();
+
+	//! Find the colliding pairs among a list of objects.
+	/*!
+	\param vObjects the objects to test. Objects that are not solid are ignored.
+	\param jobs the job system to run the narrowphase on.
+	\param vHits filled in with the colliding pairs, ordered by first index and then by second index.
+	*/
+	void findCollisions(const std::vector<GameObject*>& vObjects, JobSystem& jobs, std::vector<Hit>& vHits);
+
+	//! Get the number of candidate pairs the broadphase produced during the last findCollisions().
+	int getNumCandidates() const;
+
+private:
+	static const int s_kiGRAIN_SIZE = 16;
+
+	class Entry
+	{
+	public:
+		int iIndex;
+		int iType;
+		sf::FloatRect bounds;
+
+		bool operator<(const Entry& other) const
+		{
+			return bounds.left < other.bounds.left || (bounds.left == other.bounds.left && iIndex < other.iIndex);
+		}
+	};
+
+	int getTypeId(const std::string& sType);
+
+	std::vector<Entry> m_vEntries;
+	std::vector<std::string> m_vTypes;
+	std::vector<std::vector<Hit> > m_vThreadHits;
+	std::vector<int> m_viThreadCandidates;
+	int m_iNumCandidates;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "CommandBuffer.h"
+#include <algorithm>
+
+/* Orders commands by key only. A stable sort keeps commands with the same key in the order they were recorded. */
+static bool compareOrder(const GameCommand& a, const GameCommand& b)
+{
+	return a.iOrder < b.iOrder;
+}
+
+/* Constructor */
+CommandBuffer::CommandBuffer()
+{
+	setNumThreads(1);
+}
+
+void CommandBuffer::setNumThreads(int iNumThreads)
+{
+	m_vThreadCommands.resize(iNumThreads > 0 ? iNumThreads : 1);
+}
+
+void CommandBuffer::spawn(int iThread, int iOrder, GameObject* pGO)
+{
+	GameCommand command;
+	command.type = GameCommand::SPAWN;
+	command.iOrder = iOrder;
+	command.pObject = pGO;
+	record(iThread, command);
+}
+
+void CommandBuffer::destroy(int iThread, int iOrder, GameObject* pGO)
+{
+	GameCommand command;
+	command.type = GameCommand::DESTROY;
+	command.iOrder = iOrder;
+	command.pObject = pGO;
+	record(iThread, command);
+}
+
+/* All the commands for one key come from the same job, which ran on one thread, so they are already in */
+/* recording order within that thread's list. */
+const std::vector<GameCommand>& CommandBuffer::merge()
+{
+	m_vMerged.clear();
+	for (unsigned int i = 0; i < m_vThreadCommands.size(); i++)
+	{
+		std::vector<GameCommand>& vCommands = m_vThreadCommands[i].vCommands;
+		m_vMerged.insert(m_vMerged.end(), vCommands.begin(), vCommands.end());
+		vCommands.clear();
+	}
+	std::stable_sort(m_vMerged.begin(), m_vMerged.end(), compareOrder);
+	return m_vMerged;
+}
+
+void CommandBuffer::record(int iThread, const GameCommand& command)
+{
+	m_vThreadCommands[iThread].vCommands.push_back(command);
+}
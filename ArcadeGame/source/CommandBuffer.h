@@ -0,0 +1,77 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include "GameObject.h"
+#include <vector>
+
+//! The GameCommand class
+
+/*!
+A change to the game recorded for later, by CommandBuffer.
+*/
+class GameCommand
+{
+public:
+	enum Type {SPAWN, DESTROY};
+
+	Type type;
+	//! Decides the order commands are applied in. See CommandBuffer.
+	int iOrder;
+	//! The object spawned or destroyed.
+	GameObject* pObject;
+};
+
+//! The CommandBuffer class
+
+/*!
+Lets jobs running on JobSystem threads spawn and destroy objects without touching the game's object
+list. Each thread records into a list of its own, so recording needs no locks. At fixed points in the
+tick the game calls merge() and applies the commands on its own thread.
+
+Every command carries an order key, normally the index of the object or item whose job recorded it.
+Commands are applied in order of key, and in the order they were recorded for the same key, so the
+result does not depend on how the work was split between threads.
+*/
+class CommandBuffer
+{
+public:
+	//! CommandBuffer constructor.
+	CommandBuffer();
+
+	//! Set the number of threads that may record commands. This must not be called while commands are being recorded.
+	void setNumThreads(int iNumThreads);
+
+	//! Record that an object should be added to the game.
+	/*!
+	\param iThread the index of the recording thread, as passed to a JobSystem::ThreadRangeFunction.
+	\param iOrder the order key.
+	\param pGO the new object. The game takes ownership of it when the command is applied.
+	*/
+	void spawn(int iThread, int iOrder, GameObject* pGO);
+
+	//! Record that an object should be removed from the game and deleted. Each object must only be destroyed once.
+	void destroy(int iThread, int iOrder, GameObject* pGO);
+
+	//! Gather the commands recorded by every thread into one list, in the order they should be applied.
+	/*!
+	The threads' lists are emptied, ready for recording to start again.
+	\return the merged list. It stays valid until the next call to merge().
+	*/
+	const std::vector<GameCommand>& merge();
+
+private:
+	/* Padded so that two threads never write to the same cache line when recording. */
+	class ThreadCommands
+	{
+	public:
+		std::vector<GameCommand> vCommands;
+		char acPadding[64];
+	};
+
+	void record(int iThread, const GameCommand& command);
+
+	std::vector<ThreadCommands> m_vThreadCommands;
+	std::vector<GameCommand> m_vMerged;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include "SFML/Config.hpp"
+
+//! The FixedPoint class
+
+/*!
+Helpers for fixed-point numbers: 32-bit integers counting in steps of 1/8192. Integer arithmetic gives
+the same results on every compiler, optimisation level and instruction set, which float arithmetic does
+not, so the game can move its objects this way when replays must play back exactly across builds.
+
+13 bits after the point leaves room for a float's 24-bit mantissa to hold any value below 2048 exactly.
+Positions on the screen, and well beyond it, can therefore be kept in GameObjects as floats and converted
+back without loss, so the simulation stays in fixed point while everything else carries on reading floats.
+
+Sines come from a table built with integer arithmetic when the program starts, as the results of sin()
+differ between C libraries.
+*/
+class FixedPoint
+{
+public:
+	static const int s_kiFRACTION_BITS = 13;
+	static const sf::Int32 s_kiONE = 1 << s_kiFRACTION_BITS;
+
+	//! Convert a float to the nearest fixed-point value.
+	static sf::Int32 fromFloat(float fValue);
+
+	//! Convert a fixed-point value to a float. This is exact for values below 2048.
+	static float toFloat(sf::Int32 iValue);
+
+	//! Convert a whole number to fixed point.
+	static sf::Int32 fromInt(int iValue);
+
+	//! Multiply two fixed-point values, rounding to the nearest.
+	static sf::Int32 multiply(sf::Int32 iA, sf::Int32 iB);
+
+	//! Get the sine of an angle.
+	/*!
+	\param iAngle the angle in radians, in fixed point. Any angle can be given.
+	\return the sine, in fixed point, within about 1/4000 of the true value.
+	*/
+	static sf::Int32 sine(sf::Int32 iAngle);
+};
+
+#endif
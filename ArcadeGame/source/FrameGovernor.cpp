@@ -0,0 +1,92 @@
+#include "FrameGovernor.h"
+
+static const char* s_kasLEVEL_NAMES[] = {"full quality", "no cosmetics", "capped spawns", "half-rate rendering"};
+
+/* Constructor */
+FrameGovernor::FrameGovernor(sf::Int64 iBudget)
+{
+	m_iBudget = iBudget;
+	m_iAverageLoad = 0;
+	m_Level = FULL_QUALITY;
+	m_iFramesOverloaded = 0;
+	m_iFramesCalm = 0;
+	for (int i = 0; i < NUM_LEVELS; i++)
+	{
+		m_aiFramesAtLevel[i] = 0;
+	}
+	m_iNumLevelChanges = 0;
+}
+
+/* The average weights the latest frame by 1/8, which smooths out single slow frames (e.g. a texture being */
+/* streamed in) while still reacting within a few frames to sustained load. After a change of level the */
+/* counts start again, so each level gets a chance to take effect before the next is considered. */
+bool FrameGovernor::addFrame(sf::Int64 iLoad)
+{
+	m_aiFramesAtLevel[m_Level]++;
+	m_iAverageLoad = (m_iAverageLoad * 7 + iLoad) / 8;
+
+	if (m_iAverageLoad * 100 > m_iBudget * s_kiSTEP_UP_LOAD)
+	{
+		m_iFramesOverloaded++;
+		m_iFramesCalm = 0;
+	}
+	else if (m_iAverageLoad * 100 < m_iBudget * s_kiSTEP_DOWN_LOAD)
+	{
+		m_iFramesCalm++;
+		m_iFramesOverloaded = 0;
+	}
+	else
+	{
+		m_iFramesOverloaded = 0;
+		m_iFramesCalm = 0;
+	}
+
+	Level previousLevel = m_Level;
+	if (m_iFramesOverloaded >= s_kiFRAMES_TO_STEP_UP && m_Level + 1 < NUM_LEVELS)
+	{
+		m_Level = static_cast<Level>(m_Level + 1);
+	}
+	else if (m_iFramesCalm >= s_kiFRAMES_TO_STEP_DOWN && m_Level > FULL_QUALITY)
+	{
+		m_Level = static_cast<Level>(m_Level - 1);
+	}
+
+	if (m_Level == previousLevel)
+	{
+		return false;
+	}
+	m_iFramesOverloaded = 0;
+	m_iFramesCalm = 0;
+	m_iNumLevelChanges++;
+	return true;
+}
+
+FrameGovernor::Level FrameGovernor::getLevel() const
+{
+	return m_Level;
+}
+
+sf::Int64 FrameGovernor::getAverageLoad() const
+{
+	return m_iAverageLoad;
+}
+
+sf::Int64 FrameGovernor::getBudget() const
+{
+	return m_iBudget;
+}
+
+int FrameGovernor::getNumFramesAtLevel(Level level) const
+{
+	return level >= 0 && level < NUM_LEVELS ? m_aiFramesAtLevel[level] : 0;
+}
+
+int FrameGovernor::getNumLevelChanges() const
+{
+	return m_iNumLevelChanges;
+}
+
+const char* FrameGovernor::getLevelName(Level level)
+{
+	return level >= 0 && level < NUM_LEVELS ? s_kasLEVEL_NAMES[level] : "";
+}
@@ -0,0 +1,70 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include "SFML/System.hpp"
+
+//! The FrameGovernor class
+
+/*!
+Watches how long each frame's work takes and decides how much of it to shed when the machine cannot
+keep up, so that input handling and the simulation stay on time. Cosmetic work goes first, then the
+rate at which enemies are spawned, and finally every other frame is left undrawn.
+
+The governor steps up one level at a time when the average load stays close to the budget, and back
+down one level at a time once the load has been comfortably below it for a while, so it does not flap
+between levels.
+*/
+class FrameGovernor
+{
+public:
+	enum Level {FULL_QUALITY, NO_COSMETICS, CAPPED_SPAWNS, HALF_RATE_RENDERING, NUM_LEVELS};
+
+	//! FrameGovernor constructor. The governor starts at FULL_QUALITY.
+	/*!
+	\param iBudget the time available for each frame, in microseconds.
+	*/
+	FrameGovernor(sf::Int64 iBudget);
+
+	//! Record the load of a frame and decide whether to change level.
+	/*!
+	\param iLoad the time the frame's work took, in microseconds. If the work is split across threads that
+	run at the same time, this is the longest of them.
+	\return true if the level changed.
+	*/
+	bool addFrame(sf::Int64 iLoad);
+
+	//! Get the current level.
+	Level getLevel() const;
+
+	//! Get the recent average load, in microseconds.
+	sf::Int64 getAverageLoad() const;
+
+	//! Get the time available for each frame, in microseconds.
+	sf::Int64 getBudget() const;
+
+	//! Get the number of frames spent at a level.
+	int getNumFramesAtLevel(Level level) const;
+
+	//! Get the number of times the level has changed.
+	int getNumLevelChanges() const;
+
+	//! Get a short description of a level, for reports.
+	static const char* getLevelName(Level level);
+
+private:
+	/* Percentages of the budget. */
+	static const int s_kiSTEP_UP_LOAD = 90;
+	static const int s_kiSTEP_DOWN_LOAD = 60;
+	static const int s_kiFRAMES_TO_STEP_UP = 5;
+	static const int s_kiFRAMES_TO_STEP_DOWN = 60;
+
+	sf::Int64 m_iBudget;
+	sf::Int64 m_iAverageLoad;
+	Level m_Level;
+	int m_iFramesOverloaded;
+	int m_iFramesCalm;
+	int m_aiFramesAtLevel[NUM_LEVELS];
+	int m_iNumLevelChanges;
+};
+
+#endif
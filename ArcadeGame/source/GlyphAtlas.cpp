@@ -0,0 +1,156 @@
+#include "GlyphAtlas.h"
+#include <iostream>
+#include <algorithm>
+
+const char* const GlyphAtlas::s_kDEFAULT_CHARACTER_SET =
+	" !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+
+/* Constructor */
+GlyphAtlas::GlyphAtlas()
+{
+}
+
+/* Rasterizes every declared glyph into the font's page for its size, then stacks the pages vertically */
+/* into a single image so that all sizes share one texture. */
+bool GlyphAtlas::build(std::string sFontPath, const std::vector<unsigned int>& vSizes, std::string sCharacterSet)
+{
+	if (!m_Font.loadFromFile(sFontPath))
+	{
+		return false;
+	}
+
+	m_vSizes.clear();
+	m_vSizes.resize(vSizes.size());
+
+	/* Rasterize everything first. Pages can grow while glyphs are being added, so their final size is */
+	/* only known once every glyph for that size exists. */
+	for (unsigned int i = 0; i < vSizes.size(); i++)
+	{
+		for (unsigned int j = 0; j < sCharacterSet.size(); j++)
+		{
+			m_Font.getGlyph(static_cast<unsigned char>(sCharacterSet[j]), vSizes[i], false);
+		}
+	}
+
+	unsigned int iAtlasWidth = 0;
+	unsigned int iAtlasHeight = 0;
+	for (unsigned int i = 0; i < vSizes.size(); i++)
+	{
+		const sf::Texture& page = m_Font.getTexture(vSizes[i]);
+		iAtlasWidth = std::max(iAtlasWidth, page.getSize().x);
+		iAtlasHeight += page.getSize().y;
+	}
+
+	if (iAtlasHeight > sf::Texture::getMaximumSize() || iAtlasWidth > sf::Texture::getMaximumSize())
+	{
+		std::cerr << "GlyphAtlas: atlas of " << iAtlasWidth << "x" << iAtlasHeight << " exceeds the maximum texture size" << std::endl;
+		return false;
+	}
+
+	m_Image.create(iAtlasWidth, iAtlasHeight, sf::Color(255, 255, 255, 0));
+
+	int iPageTop = 0;
+	for (unsigned int i = 0; i < vSizes.size(); i++)
+	{
+		const sf::Texture& page = m_Font.getTexture(vSizes[i]);
+		sf::Image pageImage = page.copyToImage();
+		m_Image.copy(pageImage, 0, iPageTop);
+
+		SizeEntry& entry = m_vSizes[i];
+		entry.iSize = vSizes[i];
+		entry.iLineSpacing = m_Font.getLineSpacing(vSizes[i]);
+		entry.iSpaceAdvance = m_Font.getGlyph(' ', vSizes[i], false).advance;
+		for (int c = 0; c < s_kiNUM_CHARACTERS; c++)
+		{
+			entry.abPresent[c] = false;
+		}
+
+		for (unsigned int j = 0; j < sCharacterSet.size(); j++)
+		{
+			unsigned char c = static_cast<unsigned char>(sCharacterSet[j]);
+			if (c >= s_kiNUM_CHARACTERS)
+			{
+				continue;
+			}
+			const sf::Glyph& glyph = m_Font.getGlyph(c, vSizes[i], false);
+			entry.abPresent[c] = true;
+			entry.aGlyphs[c].advance = glyph.advance;
+			entry.aGlyphs[c].bounds = glyph.bounds;
+			entry.aGlyphs[c].textureRect = glyph.textureRect;
+			entry.aGlyphs[c].textureRect.top += iPageTop;
+		}
+
+		entry.viKerning.assign(s_kiNUM_CHARACTERS * s_kiNUM_CHARACTERS, 0);
+		for (int iFirst = 0; iFirst < s_kiNUM_CHARACTERS; iFirst++)
+		{
+			for (int iSecond = 0; iSecond < s_kiNUM_CHARACTERS && entry.abPresent[iFirst]; iSecond++)
+			{
+				if (entry.abPresent[iSecond])
+				{
+					entry.viKerning[iFirst * s_kiNUM_CHARACTERS + iSecond] = m_Font.getKerning(iFirst, iSecond, vSizes[i]);
+				}
+			}
+		}
+
+		iPageTop += page.getSize().y;
+	}
+
+	return m_Texture.loadFromImage(m_Image);
+}
+
+const GlyphAtlas::AtlasGlyph* GlyphAtlas::getGlyph(sf::Uint32 iCharacter, unsigned int iSize) const
+{
+	const SizeEntry* pEntry = findSize(iSize);
+	if (pEntry && iCharacter < s_kiNUM_CHARACTERS && pEntry->abPresent[iCharacter])
+	{
+		return &pEntry->aGlyphs[iCharacter];
+	}
+	return NULL;
+}
+
+/* Looked up in the table made by build(), as the font changes its current size when asked, which is not safe */
+/* to do from several threads at once. */
+int GlyphAtlas::getKerning(sf::Uint32 iFirst, sf::Uint32 iSecond, unsigned int iSize) const
+{
+	const SizeEntry* pEntry = findSize(iSize);
+	if (pEntry && iFirst < s_kiNUM_CHARACTERS && iSecond < s_kiNUM_CHARACTERS)
+	{
+		return pEntry->viKerning[iFirst * s_kiNUM_CHARACTERS + iSecond];
+	}
+	return 0;
+}
+
+int GlyphAtlas::getLineSpacing(unsigned int iSize) const
+{
+	const SizeEntry* pEntry = findSize(iSize);
+	return pEntry ? pEntry->iLineSpacing : static_cast<int>(iSize);
+}
+
+int GlyphAtlas::getSpaceAdvance(unsigned int iSize) const
+{
+	const SizeEntry* pEntry = findSize(iSize);
+	return pEntry ? pEntry->iSpaceAdvance : 0;
+}
+
+const sf::Texture& GlyphAtlas::getTexture() const
+{
+	return m_Texture;
+}
+
+const sf::Image& GlyphAtlas::getImage() const
+{
+	return m_Image;
+}
+
+/* Only a handful of sizes are ever declared, so a linear search is the quickest lookup. */
+const GlyphAtlas::SizeEntry* GlyphAtlas::findSize(unsigned int iSize) const
+{
+	for (unsigned int i = 0; i < m_vSizes.size(); i++)
+	{
+		if (m_vSizes[i].iSize == iSize)
+		{
+			return &m_vSizes[i];
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,95 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include "SFML/Graphics.hpp"
+#include <string>
+#include <vector>
+
+//! The GlyphAtlas class
+
+/*!
+A single texture holding every glyph of a declared character set at a declared set of font sizes.
+sf::Font rasterizes glyphs lazily the first time each character and size is drawn, which causes a
+hitch on the first frame that shows new text. The atlas does all of that work while loading instead,
+and because every glyph lives in the same texture all text can be drawn with one draw call.
+
+Kerning is looked up while building as well, so once built the atlas is only ever read and can be
+shared by layers on different threads.
+*/
+class GlyphAtlas
+{
+public:
+	//! The printable ASCII characters. This is the default character set.
+	static const char* const s_kDEFAULT_CHARACTER_SET;
+
+	//! A glyph within the atlas.
+	class AtlasGlyph
+	{
+	public:
+		//! Offset to move horizontally to the next character.
+		int advance;
+		//! Bounding rectangle of the glyph, relative to the baseline.
+		sf::IntRect bounds;
+		//! The area of the atlas texture that holds the glyph.
+		sf::IntRect textureRect;
+	};
+
+	//! GlyphAtlas constructor.
+	GlyphAtlas();
+
+	//! Rasterize a character set at the given sizes and build the atlas texture.
+	/*!
+	\param sFontPath the path and filename of the font.
+	\param vSizes the font sizes that will be used.
+	\param sCharacterSet the characters that will be used. The default is the printable ASCII characters.
+	\return true if the atlas was built.
+	*/
+	bool build(std::string sFontPath, const std::vector<unsigned int>& vSizes, std::string sCharacterSet = s_kDEFAULT_CHARACTER_SET);
+
+	//! Get a glyph from the atlas.
+	/*!
+	\param iCharacter the character.
+	\param iSize the font size.
+	\return the glyph, or NULL if the character or size was not declared when the atlas was built.
+	*/
+	const AtlasGlyph* getGlyph(sf::Uint32 iCharacter, unsigned int iSize) const;
+
+	//! Get the kerning offset between two characters. Characters outside the character set are not kerned.
+	int getKerning(sf::Uint32 iFirst, sf::Uint32 iSecond, unsigned int iSize) const;
+
+	//! Get the line spacing for a font size.
+	int getLineSpacing(unsigned int iSize) const;
+
+	//! Get the width of a space for a font size.
+	int getSpaceAdvance(unsigned int iSize) const;
+
+	//! Get the atlas texture.
+	const sf::Texture& getTexture() const;
+
+	//! Get a copy of the atlas in system memory.
+	const sf::Image& getImage() const;
+
+private:
+	static const int s_kiNUM_CHARACTERS = 128;
+
+	class SizeEntry
+	{
+	public:
+		unsigned int iSize;
+		int iLineSpacing;
+		int iSpaceAdvance;
+		bool abPresent[s_kiNUM_CHARACTERS];
+		AtlasGlyph aGlyphs[s_kiNUM_CHARACTERS];
+		/* The kerning between every pair of characters, indexed by the first times s_kiNUM_CHARACTERS plus the second. */
+		std::vector<int> viKerning;
+	};
+
+	const SizeEntry* findSize(unsigned int iSize) const;
+
+	sf::Font m_Font;
+	std::vector<SizeEntry> m_vSizes;
+	sf::Image m_Image;
+	sf::Texture m_Texture;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "HudLayer.h"
+
+/* Constructor */
+HudLayer::HudLayer()
+{
+}
+
+/* Creates an empty counter. */
+HudLayer::CounterHandle HudLayer::createCounter(const sf::Texture* pTexture, sf::IntRect textureRect, int iXPos, int iYPos, int iSpacing)
+{
+	Counter counter;
+	counter.pTexture = pTexture;
+	counter.textureRect = textureRect;
+	counter.position = sf::Vector2f(static_cast<float>(iXPos), static_cast<float>(iYPos));
+	counter.fSpacing = static_cast<float>(iSpacing);
+	counter.iValue = 0;
+	m_vCounters.push_back(counter);
+	return static_cast<CounterHandle>(m_vCounters.size() - 1);
+}
+
+void HudLayer::setValue(CounterHandle handle, int iValue)
+{
+	if (handle < 0 || handle >= static_cast<CounterHandle>(m_vCounters.size()))
+	{
+		return;
+	}
+	if (iValue < 0)
+	{
+		iValue = 0;
+	}
+	if (m_vCounters[handle].iValue != iValue)
+	{
+		m_vCounters[handle].iValue = iValue;
+		rebuildCounter(m_vCounters[handle]);
+	}
+}
+
+int HudLayer::getValue(CounterHandle handle) const
+{
+	if (handle < 0 || handle >= static_cast<CounterHandle>(m_vCounters.size()))
+	{
+		return 0;
+	}
+	return m_vCounters[handle].iValue;
+}
+
+void HudLayer::clear()
+{
+	m_vCounters.clear();
+}
+
+/* Builds one quad per icon. Icons are centred on their position, the same way GameObjects are. */
+/* The vertex list is replaced rather than modified, as frames handed to a renderer may still hold it. */
+void HudLayer::rebuildCounter(Counter& counter)
+{
+	std::shared_ptr<std::vector<sf::Vertex> > pVertices(new std::vector<sf::Vertex>());
+	pVertices->reserve(counter.iValue * 4);
+
+	float fWidth = static_cast<float>(counter.textureRect.width);
+	float fHeight = static_cast<float>(counter.textureRect.height);
+	float u1 = static_cast<float>(counter.textureRect.left);
+	float v1 = static_cast<float>(counter.textureRect.top);
+	float u2 = u1 + fWidth;
+	float v2 = v1 + fHeight;
+
+	for (int i = 0; i < counter.iValue; i++)
+	{
+		float fLeft = counter.position.x + counter.fSpacing * i - fWidth / 2;
+		float fTop = counter.position.y - fHeight / 2;
+		pVertices->push_back(sf::Vertex(sf::Vector2f(fLeft, fTop), sf::Vector2f(u1, v1)));
+		pVertices->push_back(sf::Vertex(sf::Vector2f(fLeft + fWidth, fTop), sf::Vector2f(u2, v1)));
+		pVertices->push_back(sf::Vertex(sf::Vector2f(fLeft + fWidth, fTop + fHeight), sf::Vector2f(u2, v2)));
+		pVertices->push_back(sf::Vertex(sf::Vector2f(fLeft, fTop + fHeight), sf::Vector2f(u1, v2)));
+	}
+	counter.pVertices = pVertices;
+}
+
+/* One batch per counter. */
+void HudLayer::appendTo(RenderFrame& frame) const
+{
+	for (unsigned int i = 0; i < m_vCounters.size(); i++)
+	{
+		if (m_vCounters[i].pVertices && !m_vCounters[i].pVertices->empty())
+		{
+			RenderBatch batch;
+			batch.pTexture = m_vCounters[i].pTexture;
+			batch.pVertices = m_vCounters[i].pVertices;
+			batch.iKey = reinterpret_cast<std::size_t>(&m_vCounters[i]);
+			frame.vOverlays.push_back(batch);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef HUD_LAYER_H
+#define HUD_LAYER_H
+
+#include "SFML/Graphics.hpp"
+#include "RenderFrame.h"
+#include <vector>
+
+//! The HudLayer class
+
+/*!
+An overlay for heads-up display elements such as the player's remaining lives. HUD elements are
+not GameObjects, so they are never updated, checked against alive zones or walked by collision
+detection. Each counter keeps its own vertex list, which is only rebuilt when its value changes.
+*/
+class HudLayer
+{
+public:
+	//! A handle to a counter, as returned by createCounter().
+	typedef int CounterHandle;
+
+	//! HudLayer constructor.
+	HudLayer();
+
+	//! Create a counter that displays its value as a row of icons.
+	/*!
+	\param pTexture the texture containing the icon.
+	\param textureRect the area of the texture to use for the icon.
+	\param iXPos the x-coordinate of the centre of the first icon.
+	\param iYPos the y-coordinate of the centre of the icons.
+	\param iSpacing the horizontal distance between the centres of neighbouring icons.
+	\return the handle of the new counter. The counter starts at 0.
+	*/
+	CounterHandle createCounter(const sf::Texture* pTexture, sf::IntRect textureRect, int iXPos, int iYPos, int iSpacing);
+
+	//! Set the value of a counter, i.e. the number of icons shown. Nothing is rebuilt if the value is unchanged.
+	void setValue(CounterHandle handle, int iValue);
+
+	//! Get the value of a counter.
+	int getValue(CounterHandle handle) const;
+
+	//! Remove all counters.
+	void clear();
+
+	//! Add one batch per visible counter to a frame.
+	void appendTo(RenderFrame& frame) const;
+
+private:
+	class Counter
+	{
+	public:
+		const sf::Texture* pTexture;
+		sf::IntRect textureRect;
+		sf::Vector2f position;
+		float fSpacing;
+		int iValue;
+		std::shared_ptr<const std::vector<sf::Vertex> > pVertices;
+	};
+
+	void rebuildCounter(Counter& counter);
+
+	std::vector<Counter> m_vCounters;
+};
+
+#endif
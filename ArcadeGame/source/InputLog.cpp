@@ -0,0 +1,88 @@
+#include "InputLog.h"
+
+/* Constructor */
+InputLog::InputLog()
+{
+	m_iSeed = 0;
+	m_iKeyframeInterval = s_kiDEFAULT_KEYFRAME_INTERVAL;
+	m_bFixedPoint = false;
+}
+
+void InputLog::clear(sf::Uint64 iSeed)
+{
+	m_iSeed = iSeed;
+	m_vTicks.clear();
+	m_vKeyframes.clear();
+}
+
+void InputLog::setKeyframeInterval(int iTicks)
+{
+	m_iKeyframeInterval = iTicks > 0 ? iTicks : 1;
+}
+
+int InputLog::getKeyframeInterval() const
+{
+	return m_iKeyframeInterval;
+}
+
+sf::Uint64 InputLog::getSeed() const
+{
+	return m_iSeed;
+}
+
+void InputLog::setFixedPoint(bool bFixedPoint)
+{
+	m_bFixedPoint = bFixedPoint;
+}
+
+bool InputLog::isFixedPoint() const
+{
+	return m_bFixedPoint;
+}
+
+void InputLog::record(const InputState& input, int iLoadLevel)
+{
+	Tick tick;
+	input.getFrame(tick.input);
+	tick.iLoadLevel = iLoadLevel;
+	m_vTicks.push_back(tick);
+}
+
+void InputLog::addTick(const Tick& tick)
+{
+	m_vTicks.push_back(tick);
+}
+
+int InputLog::getNumTicks() const
+{
+	return static_cast<int>(m_vTicks.size());
+}
+
+const InputLog::Tick& InputLog::getTick(int iTick) const
+{
+	return m_vTicks[iTick];
+}
+
+bool InputLog::isKeyframeDue() const
+{
+	int iTick = getNumTicks();
+	return iTick % m_iKeyframeInterval == 0 && (m_vKeyframes.empty() || m_vKeyframes.back().iTick != iTick);
+}
+
+void InputLog::addKeyframe(const std::vector<char>& vState)
+{
+	Keyframe keyframe;
+	keyframe.iTick = getNumTicks();
+	m_vKeyframes.push_back(keyframe);
+	m_vKeyframes.back().vState = vState;
+}
+
+int InputLog::getNumKeyframes() const
+{
+	return static_cast<int>(m_vKeyframes.size());
+}
+
+const InputLog::Keyframe& InputLog::getKeyframe(int iKeyframe) const
+{
+	return m_vKeyframes[iKeyframe];
+}
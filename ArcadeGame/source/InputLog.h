@@ -0,0 +1,99 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include "InputState.h"
+#include <vector>
+
+//! The InputLog class
+
+/*!
+A recording of a game: its random seed and the input of every tick. The game runs on a fixed timestep
+and draws its random numbers from the seed, so feeding the same ticks to a new game with the same seed
+plays the game out exactly as it happened. Recordings are saved to and loaded from files by ReplayFile.
+
+Besides the keys, each tick records the load level the game was running at, as a FrameGovernor can
+change how often enemies are spawned.
+
+A recording can also hold keyframes: the whole state of the game, as written by ArcadeGame::writeState(),
+taken every few seconds. A replay can start from the keyframe before any tick rather than from the start.
+*/
+class InputLog
+{
+public:
+	//! One tick of a recording.
+	class Tick
+	{
+	public:
+		InputState::Frame input;
+		int iLoadLevel;
+	};
+
+	//! The whole state of the game before a tick.
+	class Keyframe
+	{
+	public:
+		int iTick;
+		std::vector<char> vState;
+	};
+
+	//! The number of ticks between keyframes used unless setKeyframeInterval() is called: 10 seconds.
+	static const int s_kiDEFAULT_KEYFRAME_INTERVAL = 300;
+
+	//! InputLog constructor. The log starts empty, with a seed of 0.
+	InputLog();
+
+	//! Empty the log and set the seed of the game about to be recorded.
+	void clear(sf::Uint64 iSeed);
+
+	//! Set the number of ticks between keyframes. This should be done before anything is recorded.
+	void setKeyframeInterval(int iTicks);
+
+	//! Get the number of ticks between keyframes.
+	int getKeyframeInterval() const;
+
+	//! Get the seed of the recorded game.
+	sf::Uint64 getSeed() const;
+
+	//! Record whether the game moves its objects in fixed point, which it must do again when played back.
+	void setFixedPoint(bool bFixedPoint);
+
+	//! Check whether the recorded game moved its objects in fixed point.
+	bool isFixedPoint() const;
+
+	//! Add a tick to the end of the log.
+	/*!
+	\param input the input passed to the tick's gameMain().
+	\param iLoadLevel the game's load level during the tick.
+	*/
+	void record(const InputState& input, int iLoadLevel);
+
+	//! Add a tick that has already been recorded to the end of the log, e.g. one read from a file.
+	void addTick(const Tick& tick);
+
+	//! Get the number of ticks recorded.
+	int getNumTicks() const;
+
+	//! Get a recorded tick.
+	const Tick& getTick(int iTick) const;
+
+	//! Check whether a keyframe should be added before the next tick is recorded.
+	bool isKeyframeDue() const;
+
+	//! Add a keyframe for the next tick to be recorded, i.e. the state of the game before it runs.
+	void addKeyframe(const std::vector<char>& vState);
+
+	//! Get the number of keyframes.
+	int getNumKeyframes() const;
+
+	//! Get a keyframe. Keyframes are in the order they were added.
+	const Keyframe& getKeyframe(int iKeyframe) const;
+
+private:
+	sf::Uint64 m_iSeed;
+	int m_iKeyframeInterval;
+	bool m_bFixedPoint;
+	std::vector<Tick> m_vTicks;
+	std::vector<Keyframe> m_vKeyframes;
+};
+
+#endif
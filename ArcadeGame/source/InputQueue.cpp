@@ -0,0 +1,50 @@
+#include "InputQueue.h"
+#include <thread>
+
+/* Constructor */
+InputQueue::InputQueue()
+{
+}
+
+sf::Int64 InputQueue::getTime() const
+{
+	return m_Clock.getElapsedTime().asMicroseconds();
+}
+
+const sf::Clock& InputQueue::getClock() const
+{
+	return m_Clock;
+}
+
+/* The mutex is taken after the event is queued, only so that the wake-up cannot be missed by a game */
+/* thread that has just found the queue empty in waitForEvent(). */
+void InputQueue::push(InputEvent::Type type, InputState::Key key)
+{
+	InputEvent event;
+	event.type = type;
+	event.key = key;
+	event.iTime = getTime();
+	while (!m_Events.push(event))
+	{
+		std::this_thread::yield();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+	}
+	m_EventPushed.notify_one();
+}
+
+bool InputQueue::pop(InputEvent& event)
+{
+	return m_Events.pop(event);
+}
+
+void InputQueue::waitForEvent()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (m_Events.isEmpty())
+	{
+		m_EventPushed.wait(lock);
+	}
+}
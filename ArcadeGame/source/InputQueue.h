@@ -0,0 +1,78 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include "InputState.h"
+#include "SpscQueue.h"
+#include <mutex>
+#include <condition_variable>
+
+//! The InputEvent class
+
+/*!
+Something the player did, as queued by InputQueue.
+*/
+class InputEvent
+{
+public:
+	enum Type {KEY_PRESSED, KEY_RELEASED, LOST_FOCUS, GAINED_FOCUS, CLOSED};
+
+	Type type;
+	//! The key pressed or released, for KEY_PRESSED and KEY_RELEASED.
+	InputState::Key key;
+	//! When the event was received, in microseconds by InputQueue::getTime().
+	sf::Int64 iTime;
+};
+
+//! The InputQueue class
+
+/*!
+Carries InputEvents from the thread that handles the window's events to the thread that runs the game.
+Each event is stamped with the time it was received, so the game can tell exactly when during a tick a
+key went down or up, however long it is until the game gets round to reading it.
+
+The queue itself is lock-free. A mutex is only used to let the game thread sleep until an event arrives.
+*/
+class InputQueue
+{
+public:
+	//! InputQueue constructor. The clock used for timestamps starts now.
+	InputQueue();
+
+	//! Get the current time in microseconds, by the clock used to stamp events. Any thread may call this.
+	sf::Int64 getTime() const;
+
+	//! Get the clock used to stamp events.
+	const sf::Clock& getClock() const;
+
+	//! Stamp an event with the current time and queue it. Only the event thread may call this.
+	/*!
+	Events are never dropped. If the game has fallen so far behind that the queue is full, this waits
+	for room.
+	\param type the type of event.
+	\param key the key, for KEY_PRESSED and KEY_RELEASED.
+	*/
+	void push(InputEvent::Type type, InputState::Key key = InputState::NUM_KEYS);
+
+	//! Take the oldest queued event. Only the game thread may call this.
+	/*!
+	\return false if there are no events.
+	*/
+	bool pop(InputEvent& event);
+
+	//! Sleep until there is at least one event queued. Only the game thread may call this.
+	void waitForEvent();
+
+private:
+	static const unsigned int s_kiCAPACITY = 1024;
+
+	sf::Clock m_Clock;
+	SpscQueue<InputEvent, s_kiCAPACITY> m_Events;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_EventPushed;
+
+	InputQueue(const InputQueue&);
+	InputQueue& operator=(const InputQueue&);
+};
+
+#endif
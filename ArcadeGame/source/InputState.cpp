@@ -0,0 +1,161 @@
+#include "InputState.h"
+
+/* Constructor */
+InputState::InputState()
+{
+	m_iFrameStart = 0;
+	m_iFrameEnd = 0;
+	for (int i = 0; i < NUM_KEYS; i++)
+	{
+		m_aiPressTime[i] = 0;
+		m_aiHeldTime[i] = 0;
+		m_aiHeldFraction[i] = 0;
+	}
+}
+
+InputState::Key InputState::fromKeyboard(sf::Keyboard::Key code)
+{
+	switch (code)
+	{
+	case sf::Keyboard::Left: return KEY_LEFT;
+	case sf::Keyboard::Right: return KEY_RIGHT;
+	case sf::Keyboard::Up: return KEY_UP;
+	case sf::Keyboard::Down: return KEY_DOWN;
+	case sf::Keyboard::Space: return KEY_SPACE;
+	case sf::Keyboard::R: return KEY_R;
+	case sf::Keyboard::A: return KEY_A;
+	case sf::Keyboard::S: return KEY_S;
+	case sf::Keyboard::W: return KEY_W;
+	case sf::Keyboard::D: return KEY_D;
+	default: return NUM_KEYS;
+	}
+}
+
+/* Keys still held carry over into the new tick from its start. */
+void InputState::newFrame(sf::Int64 iTime)
+{
+	m_Pressed.reset();
+	m_Released.reset();
+	m_iFrameStart = iTime;
+	m_iFrameEnd = iTime;
+	for (int i = 0; i < NUM_KEYS; i++)
+	{
+		m_aiPressTime[i] = iTime;
+		m_aiHeldTime[i] = 0;
+	}
+	updateHeldFractions();
+}
+
+void InputState::endFrame(sf::Int64 iTime)
+{
+	m_iFrameEnd = iTime > m_iFrameStart ? iTime : m_iFrameStart;
+	updateHeldFractions();
+}
+
+/* A press while the key is already held (e.g. a repeat) is not a new edge. */
+void InputState::press(Key key, sf::Int64 iTime)
+{
+	if (key < 0 || key >= NUM_KEYS || m_Held[key])
+	{
+		return;
+	}
+	m_Held[key] = true;
+	m_Pressed[key] = true;
+	m_aiPressTime[key] = clampToFrame(iTime);
+}
+
+void InputState::release(Key key, sf::Int64 iTime)
+{
+	if (key < 0 || key >= NUM_KEYS || !m_Held[key])
+	{
+		return;
+	}
+	m_Held[key] = false;
+	m_Released[key] = true;
+	m_aiHeldTime[key] += clampToFrame(iTime) - m_aiPressTime[key];
+}
+
+void InputState::releaseAll(sf::Int64 iTime)
+{
+	for (int i = 0; i < NUM_KEYS; i++)
+	{
+		release(static_cast<Key>(i), iTime);
+	}
+}
+
+bool InputState::isHeld(Key key) const
+{
+	return key >= 0 && key < NUM_KEYS && m_Held[key];
+}
+
+bool InputState::wasPressed(Key key) const
+{
+	return key >= 0 && key < NUM_KEYS && m_Pressed[key];
+}
+
+bool InputState::wasReleased(Key key) const
+{
+	return key >= 0 && key < NUM_KEYS && m_Released[key];
+}
+
+float InputState::getHeldFraction(Key key) const
+{
+	if (key < 0 || key >= NUM_KEYS)
+	{
+		return 0;
+	}
+	return m_aiHeldFraction[key] / 255.0f;
+}
+
+void InputState::getFrame(Frame& frame) const
+{
+	frame.iHeld = static_cast<sf::Uint16>(m_Held.to_ulong());
+	frame.iPressed = static_cast<sf::Uint16>(m_Pressed.to_ulong());
+	frame.iReleased = static_cast<sf::Uint16>(m_Released.to_ulong());
+	for (int i = 0; i < NUM_KEYS; i++)
+	{
+		frame.aiHeldFraction[i] = m_aiHeldFraction[i];
+	}
+}
+
+void InputState::setFrame(const Frame& frame)
+{
+	m_Held = std::bitset<NUM_KEYS>(frame.iHeld);
+	m_Pressed = std::bitset<NUM_KEYS>(frame.iPressed);
+	m_Released = std::bitset<NUM_KEYS>(frame.iReleased);
+	for (int i = 0; i < NUM_KEYS; i++)
+	{
+		m_aiHeldFraction[i] = frame.aiHeldFraction[i];
+	}
+}
+
+/* Times before the start of the tick come from events that arrived too late for the previous one. */
+sf::Int64 InputState::clampToFrame(sf::Int64 iTime) const
+{
+	return iTime > m_iFrameStart ? iTime : m_iFrameStart;
+}
+
+/* A tick with no length (e.g. when no times are given) counts keys held at its end as held throughout. */
+void InputState::updateHeldFractions()
+{
+	sf::Int64 iFrameLength = m_iFrameEnd - m_iFrameStart;
+	for (int i = 0; i < NUM_KEYS; i++)
+	{
+		if (iFrameLength <= 0)
+		{
+			m_aiHeldFraction[i] = m_Held[i] ? 255 : 0;
+			continue;
+		}
+
+		sf::Int64 iHeldTime = m_aiHeldTime[i];
+		if (m_Held[i])
+		{
+			iHeldTime += m_iFrameEnd - m_aiPressTime[i];
+		}
+		if (iHeldTime >= iFrameLength)
+		{
+			iHeldTime = iFrameLength;
+		}
+		m_aiHeldFraction[i] = static_cast<sf::Uint8>((iHeldTime * 255 + iFrameLength / 2) / iFrameLength);
+	}
+}
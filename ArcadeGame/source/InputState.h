@@ -0,0 +1,114 @@
+#ifndef INPUT_STATE_H
+#define INPUT_STATE_H
+
+#include "SFML/Graphics.hpp"
+#include <bitset>
+
+//! The InputState class
+
+/*!
+The state of the keys the game uses during one tick: which are held down, and which were pressed
+or released since the previous tick. Keys are tracked as bits, so any number of keys can change
+in one tick without any being lost, and nothing is allocated.
+
+If a key is pressed and released within one tick, both edges are reported although the key is no
+longer held.
+
+Presses and releases can be given the time they happened. Together with the times passed to newFrame()
+and endFrame(), this tells the game what fraction of the tick each key was held for. Without times,
+a key counts as held for the whole tick if it is held at the end of it.
+*/
+class InputState
+{
+public:
+	enum Key {KEY_LEFT, KEY_RIGHT, KEY_UP, KEY_DOWN, KEY_SPACE, KEY_R, KEY_A, KEY_S, KEY_W, KEY_D, NUM_KEYS};
+
+	//! Everything the game can see of one tick's input, as a plain value that can be recorded and played back.
+	class Frame
+	{
+	public:
+		//! One bit per key, bit 0 being KEY_LEFT.
+		sf::Uint16 iHeld;
+		sf::Uint16 iPressed;
+		sf::Uint16 iReleased;
+		//! The fraction of the tick each key was held for, in 255ths.
+		sf::Uint8 aiHeldFraction[NUM_KEYS];
+	};
+
+	//! InputState constructor. No keys are held.
+	InputState();
+
+	//! Get the game key for an SFML key code.
+	/*!
+	\return the key, or NUM_KEYS if the game does not use the key.
+	*/
+	static Key fromKeyboard(sf::Keyboard::Key code);
+
+	//! Start a new tick, forgetting the pressed and released edges. Call this before handling the tick's events.
+	/*!
+	\param iTime the time the tick starts, in microseconds.
+	*/
+	void newFrame(sf::Int64 iTime = 0);
+
+	//! Finish the tick, once all its events have been handled.
+	/*!
+	\param iTime the time the tick ends, in microseconds. This should be no earlier than any event in it.
+	*/
+	void endFrame(sf::Int64 iTime = 0);
+
+	//! Record that a key has been pressed. Keys outside the enum are ignored.
+	/*!
+	\param key the key.
+	\param iTime the time it was pressed, in microseconds. Times before the start of the tick count as the start.
+	*/
+	void press(Key key, sf::Int64 iTime = 0);
+
+	//! Record that a key has been released. Keys outside the enum are ignored.
+	/*!
+	\param key the key.
+	\param iTime the time it was released, in microseconds.
+	*/
+	void release(Key key, sf::Int64 iTime = 0);
+
+	//! Release every held key, e.g. when the window loses focus and will not see the key up events.
+	void releaseAll(sf::Int64 iTime = 0);
+
+	//! Check whether a key is held down.
+	bool isHeld(Key key) const;
+
+	//! Check whether a key was pressed since the last call to newFrame().
+	bool wasPressed(Key key) const;
+
+	//! Check whether a key was released since the last call to newFrame().
+	bool wasReleased(Key key) const;
+
+	//! Get the fraction of the tick that a key was held for, from 0 to 1. Only valid after endFrame().
+	/*!
+	Fractions are rounded to 255ths, so that a recorded Frame plays back exactly.
+	*/
+	float getHeldFraction(Key key) const;
+
+	//! Copy what the game can see of the tick's input. Only valid after endFrame().
+	void getFrame(Frame& frame) const;
+
+	//! Replace the tick's input with a recorded frame, e.g. to play back a recording.
+	void setFrame(const Frame& frame);
+
+private:
+	sf::Int64 clampToFrame(sf::Int64 iTime) const;
+	void updateHeldFractions();
+
+	std::bitset<NUM_KEYS> m_Held;
+	std::bitset<NUM_KEYS> m_Pressed;
+	std::bitset<NUM_KEYS> m_Released;
+
+	sf::Int64 m_iFrameStart;
+	sf::Int64 m_iFrameEnd;
+	/* When each held key went down, or the start of the tick if it was already held then. */
+	sf::Int64 m_aiPressTime[NUM_KEYS];
+	/* How long each key was held for during the tick, up to its last release. */
+	sf::Int64 m_aiHeldTime[NUM_KEYS];
+	sf::Uint8 m_aiHeldFraction[NUM_KEYS];
+};
+
+#endif
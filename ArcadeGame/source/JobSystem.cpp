@@ -0,0 +1,270 @@
+#include "JobSystem.h"
+#include <chrono>
+
+/* Constructor */
+JobSystem::JobSystem(int iNumWorkers)
+{
+	if (iNumWorkers < 0)
+	{
+		int iHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+		iNumWorkers = iHardwareThreads > 1 ? iHardwareThreads - 1 : 0;
+	}
+
+	m_pFunction = NULL;
+	m_iGrainSize = s_kiDEFAULT_GRAIN_SIZE;
+	m_iNumRemaining = 0;
+	m_iGeneration = 0;
+	m_bStopping = false;
+	m_iDefaultGrainSize = s_kiDEFAULT_GRAIN_SIZE;
+	m_iSerialThreshold = s_kiDEFAULT_SERIAL_THRESHOLD;
+
+	for (int i = 0; i < iNumWorkers + 1; i++)
+	{
+		m_vThreadData.push_back(new ThreadData());
+	}
+	resetStats();
+
+	for (int i = 0; i < iNumWorkers; i++)
+	{
+		m_vWorkers.push_back(std::thread(&JobSystem::workerMain, this, i + 1));
+	}
+}
+
+/* Destructor */
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_bStopping = true;
+	}
+	m_Wake.notify_all();
+
+	for (unsigned int i = 0; i < m_vWorkers.size(); i++)
+	{
+		m_vWorkers[i].join();
+	}
+	for (unsigned int i = 0; i < m_vThreadData.size(); i++)
+	{
+		delete m_vThreadData[i];
+	}
+}
+
+void JobSystem::parallelFor(int iBegin, int iEnd, int iGrainSize, const RangeFunction& function)
+{
+	parallelForWithThreadIndex(iBegin, iEnd, iGrainSize, [&function](int, int iRangeBegin, int iRangeEnd)
+	{
+		function(iRangeBegin, iRangeEnd);
+	});
+}
+
+/* The whole range starts in the calling thread's queue. The workers are woken to steal from it, and */
+/* the calling thread keeps running and stealing ranges until every index has been processed. */
+void JobSystem::parallelForWithThreadIndex(int iBegin, int iEnd, int iGrainSize, const ThreadRangeFunction& function)
+{
+	if (iEnd <= iBegin)
+	{
+		return;
+	}
+
+	if (m_vWorkers.empty() || iEnd - iBegin <= m_iSerialThreshold)
+	{
+		long long iStartTime = getTime();
+		function(0, iBegin, iEnd);
+		m_vThreadData[0]->iBusyTime += getTime() - iStartTime;
+		m_vThreadData[0]->iNumRangesRun++;
+		return;
+	}
+
+	m_pFunction = &function;
+	m_iGrainSize = iGrainSize > 0 ? iGrainSize : m_iDefaultGrainSize;
+	m_iNumRemaining = iEnd - iBegin;
+
+	Range range = {iBegin, iEnd};
+	{
+		std::lock_guard<std::mutex> lock(m_vThreadData[0]->mutex);
+		m_vThreadData[0]->vRanges.push_back(range);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_iGeneration++;
+	}
+	m_Wake.notify_all();
+
+	while (m_iNumRemaining > 0)
+	{
+		if (!runOneRange(0))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	m_pFunction = NULL;
+}
+
+void JobSystem::setGrainSize(int iGrainSize)
+{
+	m_iDefaultGrainSize = iGrainSize > 0 ? iGrainSize : 1;
+}
+
+int JobSystem::getGrainSize() const
+{
+	return m_iDefaultGrainSize;
+}
+
+void JobSystem::setSerialThreshold(int iThreshold)
+{
+	m_iSerialThreshold = iThreshold;
+}
+
+int JobSystem::getSerialThreshold() const
+{
+	return m_iSerialThreshold;
+}
+
+int JobSystem::getNumThreads() const
+{
+	return static_cast<int>(m_vThreadData.size());
+}
+
+float JobSystem::getUtilization(int iThread) const
+{
+	long long iElapsed = getTime() - m_iStatsStartTime;
+	if (iThread < 0 || iThread >= getNumThreads() || iElapsed <= 0)
+	{
+		return 0;
+	}
+	return static_cast<float>(m_vThreadData[iThread]->iBusyTime) / iElapsed;
+}
+
+int JobSystem::getNumSteals(int iThread) const
+{
+	if (iThread < 0 || iThread >= getNumThreads())
+	{
+		return 0;
+	}
+	return m_vThreadData[iThread]->iNumSteals;
+}
+
+int JobSystem::getNumRangesRun(int iThread) const
+{
+	if (iThread < 0 || iThread >= getNumThreads())
+	{
+		return 0;
+	}
+	return m_vThreadData[iThread]->iNumRangesRun;
+}
+
+void JobSystem::resetStats()
+{
+	for (unsigned int i = 0; i < m_vThreadData.size(); i++)
+	{
+		m_vThreadData[i]->iBusyTime = 0;
+		m_vThreadData[i]->iNumSteals = 0;
+		m_vThreadData[i]->iNumRangesRun = 0;
+	}
+	m_iStatsStartTime = getTime();
+}
+
+/* A worker sleeps until parallelFor() starts a job, then helps until the job is finished. */
+void JobSystem::workerMain(int iThread)
+{
+	int iLastGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_WakeMutex);
+			while (!m_bStopping && m_iGeneration == iLastGeneration)
+			{
+				m_Wake.wait(lock);
+			}
+			if (m_bStopping)
+			{
+				return;
+			}
+			iLastGeneration = m_iGeneration;
+		}
+
+		while (m_iNumRemaining > 0)
+		{
+			if (!runOneRange(iThread))
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+
+/* Runs a range from the thread's own queue, or one stolen from another thread. Returns false if there was none. */
+bool JobSystem::runOneRange(int iThread)
+{
+	Range range;
+	if (popRange(iThread, range) || stealRange(iThread, range))
+	{
+		runRange(iThread, range);
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::popRange(int iThread, Range& range)
+{
+	ThreadData& data = *m_vThreadData[iThread];
+	std::lock_guard<std::mutex> lock(data.mutex);
+	if (data.vRanges.empty())
+	{
+		return false;
+	}
+	range = data.vRanges.back();
+	data.vRanges.pop_back();
+	return true;
+}
+
+/* Tries every other thread in turn, starting with the next one along so that thieves spread out. */
+bool JobSystem::stealRange(int iThread, Range& range)
+{
+	int iNumThreads = getNumThreads();
+	for (int i = 1; i < iNumThreads; i++)
+	{
+		ThreadData& victim = *m_vThreadData[(iThread + i) % iNumThreads];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.vRanges.empty())
+		{
+			range = victim.vRanges.front();
+			victim.vRanges.pop_front();
+			m_vThreadData[iThread]->iNumSteals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Splits off the upper half of the range for others to steal until what is left fits the grain size, then runs it. */
+void JobSystem::runRange(int iThread, Range range)
+{
+	ThreadData& data = *m_vThreadData[iThread];
+	long long iStartTime = getTime();
+
+	while (range.iEnd - range.iBegin > m_iGrainSize)
+	{
+		Range upper = {range.iBegin + (range.iEnd - range.iBegin) / 2, range.iEnd};
+		{
+			std::lock_guard<std::mutex> lock(data.mutex);
+			data.vRanges.push_back(upper);
+		}
+		range.iEnd = upper.iBegin;
+	}
+
+	(*m_pFunction)(iThread, range.iBegin, range.iEnd);
+
+	data.iBusyTime += getTime() - iStartTime;
+	data.iNumRangesRun++;
+	m_iNumRemaining -= range.iEnd - range.iBegin;
+}
+
+/* Returns the current time in microseconds. */
+long long JobSystem::getTime()
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(high_resolution_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,148 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//! The JobSystem class
+
+/*!
+A small work-stealing scheduler for splitting loops across cores. parallelFor() hands a range of
+indices to a pool of worker threads. Each thread splits the ranges it holds in half until they are no
+bigger than the grain size, keeps working on the lower half and leaves the upper half in its queue
+for other threads to steal. The calling thread takes part too, and returns once the whole range is done.
+
+Ranges no bigger than the serial threshold are run directly on the calling thread, since waking the
+workers costs more than a short loop. Each thread's busy time is recorded so that utilization can be
+checked when tuning the grain size and threshold.
+
+parallelFor() must only be called from one thread at a time, and never from inside a job.
+*/
+class JobSystem
+{
+public:
+	//! The work done by a job: process every index from iBegin up to, but not including, iEnd.
+	typedef std::function<void (int iBegin, int iEnd)> RangeFunction;
+
+	//! As RangeFunction, but also given the index of the thread running it, from 0 to getNumThreads() - 1.
+	/*!
+	No two ranges run at the same time on the same thread, so the index can be used to pick a per-thread buffer.
+	*/
+	typedef std::function<void (int iThread, int iBegin, int iEnd)> ThreadRangeFunction;
+
+	//! JobSystem constructor.
+	/*!
+	\param iNumWorkers the number of worker threads to start. The default, -1, starts one fewer than the
+	number of hardware threads, since the calling thread does work as well.
+	*/
+	JobSystem(int iNumWorkers = -1);
+
+	//! JobSystem destructor. Stops the worker threads.
+	~JobSystem();
+
+	//! Run a function over a range of indices, split across all threads.
+	/*!
+	\param iBegin the first index.
+	\param iEnd one past the last index.
+	\param iGrainSize the largest number of indices given to a thread in one go. Use 0 for the default grain size.
+	\param function the function to run. It is called with sub-ranges, possibly on several threads at once.
+	*/
+	void parallelFor(int iBegin, int iEnd, int iGrainSize, const RangeFunction& function);
+
+	//! Run a function over a range of indices, split across all threads, telling it which thread it is running on.
+	/*!
+	\param iBegin the first index.
+	\param iEnd one past the last index.
+	\param iGrainSize the largest number of indices given to a thread in one go. Use 0 for the default grain size.
+	\param function the function to run.
+	*/
+	void parallelForWithThreadIndex(int iBegin, int iEnd, int iGrainSize, const ThreadRangeFunction& function);
+
+	//! Set the default grain size, used when parallelFor() is given a grain size of 0.
+	void setGrainSize(int iGrainSize);
+
+	//! Get the default grain size.
+	int getGrainSize() const;
+
+	//! Set the largest range that is run on the calling thread alone.
+	void setSerialThreshold(int iThreshold);
+
+	//! Get the largest range that is run on the calling thread alone.
+	int getSerialThreshold() const;
+
+	//! Get the number of threads that do work, including the calling thread.
+	int getNumThreads() const;
+
+	//! Get the fraction of time a thread has spent running jobs since the last resetStats().
+	/*!
+	\param iThread the thread. 0 is the calling thread and 1 upwards are the workers.
+	\return the utilization, from 0 to 1.
+	*/
+	float getUtilization(int iThread) const;
+
+	//! Get the number of ranges a thread has taken from other threads since the last resetStats().
+	int getNumSteals(int iThread) const;
+
+	//! Get the number of ranges a thread has run since the last resetStats().
+	int getNumRangesRun(int iThread) const;
+
+	//! Reset the utilization, steal and range counts of every thread.
+	void resetStats();
+
+private:
+	static const int s_kiDEFAULT_GRAIN_SIZE = 64;
+	static const int s_kiDEFAULT_SERIAL_THRESHOLD = 256;
+
+	class Range
+	{
+	public:
+		int iBegin;
+		int iEnd;
+	};
+
+	/* A thread's queue of ranges. The owner works from the back and thieves take from the front, so the */
+	/* biggest ranges, which were split off first, are the ones that get stolen. */
+	class ThreadData
+	{
+	public:
+		std::mutex mutex;
+		std::deque<Range> vRanges;
+		std::atomic<long long> iBusyTime;
+		std::atomic<int> iNumSteals;
+		std::atomic<int> iNumRangesRun;
+	};
+
+	void workerMain(int iThread);
+	bool runOneRange(int iThread);
+	bool popRange(int iThread, Range& range);
+	bool stealRange(int iThread, Range& range);
+	void runRange(int iThread, Range range);
+	static long long getTime();
+
+	std::vector<std::thread> m_vWorkers;
+	std::vector<ThreadData*> m_vThreadData;
+
+	/* The job being run. Only valid while parallelFor() is running. */
+	const ThreadRangeFunction* m_pFunction;
+	int m_iGrainSize;
+	std::atomic<int> m_iNumRemaining;
+
+	std::mutex m_WakeMutex;
+	std::condition_variable m_Wake;
+	int m_iGeneration;
+	bool m_bStopping;
+
+	int m_iDefaultGrainSize;
+	int m_iSerialThreshold;
+	long long m_iStatsStartTime;
+
+	JobSystem(const JobSystem&);
+	JobSystem& operator=(const JobSystem&);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "LookaheadBot.h"
+
+/* Constructor */
+LookaheadBot::LookaheadBot(ArcadeGame& worker, sf::Uint64 iSeed) : m_Worker(worker), m_Random(iSeed)
+{
+	m_iNumRollouts = s_kiDEFAULT_NUM_ROLLOUTS;
+	m_iHorizon = s_kiDEFAULT_HORIZON;
+	m_iRootScore = 0;
+	m_iRootHealth = 0;
+	m_iTotalRollouts = 0;
+	m_iTotalTicks = 0;
+	m_iForkTime = 0;
+	m_iSimulateTime = 0;
+}
+
+void LookaheadBot::setSearch(int iNumRollouts, int iHorizon)
+{
+	m_iNumRollouts = iNumRollouts > 1 ? iNumRollouts : 1;
+	m_iHorizon = iHorizon > 1 ? iHorizon : 1;
+}
+
+/* The state is saved once per tick and restored before every future, so the game is only copied from, never into. */
+/* On the scoreboard there is nothing to decide, so no keys are pressed. */
+void LookaheadBot::chooseInput(ArcadeGame& game, InputState& input)
+{
+	int iBestAction = 0;
+	if (game.getGameState() != ArcadeGame::SCOREBOARD)
+	{
+		game.saveState(m_Root);
+		m_Worker.setFixedPoint(game.isFixedPoint());
+		m_iRootScore = game.getScore();
+		m_iRootHealth = game.getPlayerHealth();
+
+		int iBestTotal = 0;
+		for (int iAction = 0; iAction < s_kiNUM_ACTIONS; iAction++)
+		{
+			int iTotal = 0;
+			for (int i = 0; i < m_iNumRollouts; i++)
+			{
+				iTotal += playOut(iAction);
+			}
+			if (iAction == 0 || iTotal > iBestTotal)
+			{
+				iBestAction = iAction;
+				iBestTotal = iTotal;
+			}
+		}
+
+		if (&m_Worker == &game)
+		{
+			sf::Clock clock;
+			game.restoreState(m_Root);
+			m_iForkTime += clock.getElapsedTime().asMicroseconds();
+		}
+	}
+	makeInput(iBestAction, input);
+}
+
+/* Actions are numbered by horizontal movement (none, left, right), then vertical (none, up, down), then firing. */
+/* Fire is pressed again every tick, and the game's cooldown decides when a shot actually goes off. */
+void LookaheadBot::makeInput(int iAction, InputState& input)
+{
+	static const InputState::Key s_kaHORIZONTAL_KEYS[] = {InputState::NUM_KEYS, InputState::KEY_LEFT, InputState::KEY_RIGHT};
+	static const InputState::Key s_kaVERTICAL_KEYS[] = {InputState::NUM_KEYS, InputState::KEY_UP, InputState::KEY_DOWN};
+
+	InputState::Frame frame;
+	frame.iHeld = 0;
+	frame.iPressed = 0;
+	frame.iReleased = 0;
+	InputState::Key horizontal = s_kaHORIZONTAL_KEYS[iAction % 3];
+	InputState::Key vertical = s_kaVERTICAL_KEYS[(iAction / 3) % 3];
+	if (horizontal != InputState::NUM_KEYS)
+	{
+		frame.iHeld |= 1 << horizontal;
+	}
+	if (vertical != InputState::NUM_KEYS)
+	{
+		frame.iHeld |= 1 << vertical;
+	}
+	if (iAction >= 9)
+	{
+		frame.iHeld |= 1 << InputState::KEY_SPACE;
+		frame.iPressed |= 1 << InputState::KEY_SPACE;
+	}
+	for (int i = 0; i < InputState::NUM_KEYS; i++)
+	{
+		frame.aiHeldFraction[i] = (frame.iHeld & (1 << i)) ? 255 : 0;
+	}
+	input.setFrame(frame);
+}
+
+/* Plays out one future: the action for its first few ticks, then random ones. Returns the points it gained. */
+int LookaheadBot::playOut(int iAction)
+{
+	sf::Clock clock;
+	m_Worker.restoreState(m_Root);
+	m_iForkTime += clock.restart().asMicroseconds();
+
+	InputState input;
+	for (int i = 0; i < m_iHorizon && m_Worker.getGameState() != ArcadeGame::SCOREBOARD; i++)
+	{
+		if (i > 0 && i % s_kiACTION_TICKS == 0)
+		{
+			iAction = m_Random.getInt(0, s_kiNUM_ACTIONS - 1);
+		}
+		makeInput(iAction, input);
+		m_Worker.gameMain(input);
+		m_iTotalTicks++;
+	}
+	m_iSimulateTime += clock.getElapsedTime().asMicroseconds();
+	m_iTotalRollouts++;
+
+	return (m_Worker.getScore() - m_iRootScore) - (m_iRootHealth - m_Worker.getPlayerHealth()) * s_kiPOINTS_PER_LIFE;
+}
+
+sf::Int64 LookaheadBot::getNumRollouts() const
+{
+	return m_iTotalRollouts;
+}
+
+sf::Int64 LookaheadBot::getNumTicksSimulated() const
+{
+	return m_iTotalTicks;
+}
+
+sf::Int64 LookaheadBot::getForkTime() const
+{
+	return m_iForkTime;
+}
+
+sf::Int64 LookaheadBot::getSimulateTime() const
+{
+	return m_iSimulateTime;
+}
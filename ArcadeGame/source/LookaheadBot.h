@@ -0,0 +1,84 @@
+#ifndef LOOKAHEAD_BOT_H
+#define LOOKAHEAD_BOT_H
+
+#include "ArcadeGame.h"
+
+//! The LookaheadBot class
+
+/*!
+Plays the game by trying out its options. Each tick, every action the ship can take (a direction to move
+in, with or without firing) is played out a number of times in a second game, each time followed by random
+actions up to a fixed number of ticks ahead. The action whose futures score best on average is chosen, with
+lost lives counting heavily against it.
+
+The second game is brought to the current state by restoring a snapshot rather than by creating a game,
+so each future costs a copy of the state plus the ticks run. The bot is meant as a benchmark of how fast
+the game can be forked and stepped, as much as a player.
+*/
+class LookaheadBot
+{
+public:
+	//! LookaheadBot constructor.
+	/*!
+	\param worker the game the futures are played out in. Its state is thrown away each time. It may be the
+	game being played, in which case that game is put back as it was after each choice.
+	\param iSeed the seed for the random actions, so that a bot given the same seed plays the same game.
+	*/
+	LookaheadBot(ArcadeGame& worker, sf::Uint64 iSeed);
+
+	//! Set how much searching is done for each tick.
+	/*!
+	\param iNumRollouts the number of futures played out for each action.
+	\param iHorizon the number of ticks each future is played out for.
+	*/
+	void setSearch(int iNumRollouts, int iHorizon);
+
+	//! Decide what to do in the current tick of a game.
+	/*!
+	\param game the game being played.
+	\param input set to the chosen action, ready to pass to ArcadeGame::gameMain().
+	*/
+	void chooseInput(ArcadeGame& game, InputState& input);
+
+	//! Get the total number of futures played out.
+	sf::Int64 getNumRollouts() const;
+
+	//! Get the total number of ticks run while playing out futures.
+	sf::Int64 getNumTicksSimulated() const;
+
+	//! Get the total time spent restoring the snapshot into the worker, in microseconds.
+	sf::Int64 getForkTime() const;
+
+	//! Get the total time spent running ticks in the worker, in microseconds.
+	sf::Int64 getSimulateTime() const;
+
+private:
+	/* Three ways to move along each axis, each with and without firing. */
+	static const int s_kiNUM_ACTIONS = 18;
+	/* Random actions are held for this many ticks before another is picked, as the ship barely moves in one. */
+	static const int s_kiACTION_TICKS = 5;
+	static const int s_kiPOINTS_PER_LIFE = 1000;
+	static const int s_kiDEFAULT_NUM_ROLLOUTS = 4;
+	static const int s_kiDEFAULT_HORIZON = 30;
+
+	static void makeInput(int iAction, InputState& input);
+	int playOut(int iAction);
+
+	ArcadeGame& m_Worker;
+	Random m_Random;
+	int m_iNumRollouts;
+	int m_iHorizon;
+	ArcadeGame::Snapshot m_Root;
+	int m_iRootScore;
+	int m_iRootHealth;
+
+	sf::Int64 m_iTotalRollouts;
+	sf::Int64 m_iTotalTicks;
+	sf::Int64 m_iForkTime;
+	sf::Int64 m_iSimulateTime;
+
+	LookaheadBot(const LookaheadBot&);
+	LookaheadBot& operator=(const LookaheadBot&);
+};
+
+#endif
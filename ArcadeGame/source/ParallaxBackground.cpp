@@ -0,0 +1,271 @@
+#include "ParallaxBackground.h"
+#include <math.h>
+#include <algorithm>
+
+/* Constructor */
+ParallaxBackground::ParallaxBackground(int iViewWidth, int iViewHeight)
+{
+	m_iViewWidth = iViewWidth;
+	m_iViewHeight = iViewHeight;
+}
+
+/* Destructor */
+ParallaxBackground::~ParallaxBackground()
+{
+	clear();
+}
+
+/* Loads a layer. Images that fit in a texture are uploaded once and set to repeat. Wider images are */
+/* kept in system memory and streamed as column tiles, since SFML can only decode a whole file at once. */
+int ParallaxBackground::addLayer(std::string sPath, float fScrollSpeed)
+{
+	sf::Image* pImage = new sf::Image();
+	if (!pImage->loadFromFile(sPath))
+	{
+		delete pImage;
+		return -1;
+	}
+
+	Layer layer;
+	layer.pTexture = NULL;
+	layer.bOwnsTexture = true;
+	layer.pImage = NULL;
+	layer.iWidth = pImage->getSize().x;
+	layer.iHeight = pImage->getSize().y;
+	layer.fScrollSpeed = fScrollSpeed;
+	layer.fOffset = 0;
+
+	unsigned int iMaxSize = sf::Texture::getMaximumSize();
+	if (pImage->getSize().y > iMaxSize)
+	{
+		delete pImage;
+		return -1;
+	}
+	else if (pImage->getSize().x > iMaxSize)
+	{
+		unsigned int iTileWidth = s_kiSTREAM_TILE_WIDTH < iMaxSize ? s_kiSTREAM_TILE_WIDTH : iMaxSize;
+		layer.pImage = pImage;
+		layer.vTiles.resize((layer.iWidth + iTileWidth - 1) / iTileWidth);
+	}
+	else
+	{
+		sf::Texture* pTexture = new sf::Texture();
+		pTexture->loadFromImage(*pImage);
+		pTexture->setRepeated(true);
+		layer.pTexture = pTexture;
+		delete pImage;
+	}
+
+	m_vLayers.push_back(layer);
+	if (layer.pImage)
+	{
+		streamTiles(m_vLayers.back());
+	}
+	return static_cast<int>(m_vLayers.size() - 1);
+}
+
+int ParallaxBackground::addLayer(const sf::Texture& texture, float fScrollSpeed)
+{
+	Layer layer;
+	layer.pTexture = &texture;
+	layer.bOwnsTexture = false;
+	layer.pImage = NULL;
+	layer.iWidth = texture.getSize().x;
+	layer.iHeight = texture.getSize().y;
+	layer.fScrollSpeed = fScrollSpeed;
+	layer.fOffset = 0;
+	m_vLayers.push_back(layer);
+	return static_cast<int>(m_vLayers.size() - 1);
+}
+
+void ParallaxBackground::setScrollSpeed(int iLayer, float fScrollSpeed)
+{
+	if (iLayer >= 0 && iLayer < static_cast<int>(m_vLayers.size()))
+	{
+		m_vLayers[iLayer].fScrollSpeed = fScrollSpeed;
+	}
+}
+
+int ParallaxBackground::getNumLayers() const
+{
+	return static_cast<int>(m_vLayers.size());
+}
+
+bool ParallaxBackground::isScrolling() const
+{
+	for (unsigned int i = 0; i < m_vLayers.size(); i++)
+	{
+		if (m_vLayers[i].fScrollSpeed != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Offsets are kept within one image width so they never lose precision however long the game runs. */
+void ParallaxBackground::update(float fSeconds)
+{
+	for (unsigned int i = 0; i < m_vLayers.size(); i++)
+	{
+		Layer& layer = m_vLayers[i];
+		if (layer.fScrollSpeed == 0)
+		{
+			continue;
+		}
+
+		layer.fOffset = fmod(layer.fOffset + layer.fScrollSpeed * fSeconds, static_cast<float>(layer.iWidth));
+		if (layer.fOffset < 0)
+		{
+			layer.fOffset += layer.iWidth;
+		}
+
+		if (layer.pImage)
+		{
+			streamTiles(layer);
+		}
+	}
+}
+
+void ParallaxBackground::clear()
+{
+	for (unsigned int i = 0; i < m_vLayers.size(); i++)
+	{
+		if (m_vLayers[i].bOwnsTexture)
+		{
+			delete m_vLayers[i].pTexture;
+		}
+		delete m_vLayers[i].pImage;
+	}
+	m_vLayers.clear();
+}
+
+/* Two values per layer: the offset, then the scroll speed. */
+int ParallaxBackground::getNumStateValues() const
+{
+	return 2 * static_cast<int>(m_vLayers.size());
+}
+
+void ParallaxBackground::saveState(float* pfState) const
+{
+	for (unsigned int i = 0; i < m_vLayers.size(); i++)
+	{
+		pfState[2 * i] = m_vLayers[i].fOffset;
+		pfState[2 * i + 1] = m_vLayers[i].fScrollSpeed;
+	}
+}
+
+/* Tiles are only streamed for a layer whose position has actually changed. */
+void ParallaxBackground::restoreState(const float* pfState, int iNumValues)
+{
+	for (int i = 0; i < static_cast<int>(m_vLayers.size()) && 2 * i + 1 < iNumValues; i++)
+	{
+		Layer& layer = m_vLayers[i];
+		layer.fScrollSpeed = pfState[2 * i + 1];
+		if (layer.fOffset != pfState[2 * i])
+		{
+			layer.fOffset = pfState[2 * i];
+			if (layer.pImage)
+			{
+				streamTiles(layer);
+			}
+		}
+	}
+}
+
+/* Makes sure the tiles covering the screen and the next tile to scroll in are uploaded, and releases the rest. */
+void ParallaxBackground::streamTiles(Layer& layer)
+{
+	int iNumTiles = static_cast<int>(layer.vTiles.size());
+	int iTileWidth = (layer.iWidth + iNumTiles - 1) / iNumTiles;
+	int iFirstTile = static_cast<int>(layer.fOffset) / iTileWidth;
+	int iLastTile = (static_cast<int>(layer.fOffset) + m_iViewWidth + iTileWidth) / iTileWidth;
+
+	std::vector<bool> vbNeeded(iNumTiles, false);
+	for (int i = iFirstTile; i <= iLastTile; i++)
+	{
+		vbNeeded[i % iNumTiles] = true;
+	}
+
+	for (int i = 0; i < iNumTiles; i++)
+	{
+		if (vbNeeded[i] && !layer.vTiles[i])
+		{
+			int iLeft = i * iTileWidth;
+			layer.vTiles[i].reset(new sf::Texture());
+			layer.vTiles[i]->loadFromImage(*layer.pImage, sf::IntRect(iLeft, 0, std::min(iTileWidth, layer.iWidth - iLeft), layer.iHeight));
+		}
+		else if (!vbNeeded[i] && layer.vTiles[i])
+		{
+			layer.vTiles[i].reset();
+		}
+	}
+}
+
+/* Each layer is one quad whose texture coordinates start at the scroll offset. The texture repeats, so the */
+/* coordinates are allowed to run past its right-hand edge. */
+void ParallaxBackground::appendTo(RenderFrame& frame) const
+{
+	float fViewWidth = static_cast<float>(m_iViewWidth);
+	float fViewHeight = static_cast<float>(m_iViewHeight);
+
+	for (unsigned int i = 0; i < m_vLayers.size(); i++)
+	{
+		const Layer& layer = m_vLayers[i];
+		if (layer.pImage)
+		{
+			appendStreamedLayer(layer, frame);
+			continue;
+		}
+
+		RenderQuad quad;
+		quad.pTexture = layer.pTexture;
+		quad.dest = sf::FloatRect(0, 0, fViewWidth, fViewHeight);
+		quad.source = sf::FloatRect(layer.fOffset, 0, fViewWidth, static_cast<float>(layer.iHeight));
+		quad.colour = sf::Color::White;
+		quad.iKey = reinterpret_cast<std::size_t>(layer.pTexture);
+		frame.vBackground.push_back(quad);
+	}
+}
+
+/* Walks across the screen one tile at a time, adding a quad for the visible part of each tile. */
+void ParallaxBackground::appendStreamedLayer(const Layer& layer, RenderFrame& frame) const
+{
+	int iNumTiles = static_cast<int>(layer.vTiles.size());
+	int iTileWidth = (layer.iWidth + iNumTiles - 1) / iNumTiles;
+	float fViewHeight = static_cast<float>(m_iViewHeight);
+	float fScreenX = 0;
+	float fImageX = layer.fOffset;
+
+	while (fScreenX < m_iViewWidth)
+	{
+		int iTile = static_cast<int>(fImageX) / iTileWidth;
+		float fTileLeft = static_cast<float>(iTile * iTileWidth);
+		float fTileWidth = static_cast<float>(std::min(iTileWidth, layer.iWidth - iTile * iTileWidth));
+		float u1 = fImageX - fTileLeft;
+		float fSpan = std::min(fTileWidth - u1, m_iViewWidth - fScreenX);
+		if (fSpan <= 0)
+		{
+			break;
+		}
+
+		if (layer.vTiles[iTile])
+		{
+			RenderQuad quad;
+			quad.pTexture = layer.vTiles[iTile].get();
+			quad.dest = sf::FloatRect(fScreenX, 0, fSpan, fViewHeight);
+			quad.source = sf::FloatRect(u1, 0, fSpan, static_cast<float>(layer.iHeight));
+			quad.colour = sf::Color::White;
+			quad.iKey = reinterpret_cast<std::size_t>(layer.vTiles[iTile].get());
+			frame.vBackground.push_back(quad);
+			frame.vResources.push_back(layer.vTiles[iTile]);
+		}
+
+		fScreenX += fSpan;
+		fImageX += fSpan;
+		if (fImageX >= layer.iWidth)
+		{
+			fImageX -= layer.iWidth;
+		}
+	}
+}
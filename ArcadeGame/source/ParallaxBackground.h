@@ -0,0 +1,122 @@
+#ifndef PARALLAX_BACKGROUND_H
+#define PARALLAX_BACKGROUND_H
+
+#include "SFML/Graphics.hpp"
+#include "RenderFrame.h"
+#include <string>
+#include <vector>
+
+//! The ParallaxBackground class
+
+/*!
+A scrolling background made of any number of layers, each with its own scroll speed. Layers are
+drawn back to front in the order they were added. A layer is a single quad over a repeat-wrapped
+texture, and scrolling only moves its texture coordinates, so each layer costs one quad and
+nothing has to be repositioned.
+
+Images wider than the largest texture the graphics card supports are streamed instead: the image is
+kept in system memory and only the column tiles currently on screen (plus the next one to scroll in)
+are uploaded as textures. Frames keep a reference to the tiles they use, so a tile that scrolls out
+of view is not destroyed while a frame that still shows it is being drawn on another thread.
+*/
+class ParallaxBackground
+{
+public:
+	//! ParallaxBackground constructor.
+	/*!
+	\param iViewWidth the width of the area covered by the background.
+	\param iViewHeight the height of the area covered by the background.
+	*/
+	ParallaxBackground(int iViewWidth, int iViewHeight);
+
+	//! ParallaxBackground destructor.
+	~ParallaxBackground();
+
+	//! Add a layer in front of all existing layers.
+	/*!
+	\param sPath the image name and path.
+	\param fScrollSpeed the scroll speed in pixels per second.
+	\return the index of the new layer, or -1 if the image could not be loaded.
+	*/
+	int addLayer(std::string sPath, float fScrollSpeed);
+
+	//! Add a layer in front of all existing layers, showing a texture loaded elsewhere.
+	/*!
+	The background does not take ownership of the texture, so one texture can be shared by many backgrounds.
+	It must be set to repeat and must outlive the background.
+	\param texture the texture.
+	\param fScrollSpeed the scroll speed in pixels per second.
+	\return the index of the new layer.
+	*/
+	int addLayer(const sf::Texture& texture, float fScrollSpeed);
+
+	//! Set the scroll speed of a layer.
+	/*!
+	\param iLayer the index of the layer.
+	\param fScrollSpeed the scroll speed in pixels per second.
+	*/
+	void setScrollSpeed(int iLayer, float fScrollSpeed);
+
+	//! Get the number of layers.
+	int getNumLayers() const;
+
+	//! Check whether any layer has a scroll speed other than zero.
+	bool isScrolling() const;
+
+	//! Advance the scroll of every layer.
+	/*!
+	\param fSeconds the time in seconds since the last update.
+	*/
+	void update(float fSeconds);
+
+	//! Remove all layers.
+	void clear();
+
+	//! Add the quads for every layer to the background of a frame, back to front.
+	void appendTo(RenderFrame& frame) const;
+
+	//! Get the number of values saveState() copies: a scroll position and a speed for every layer.
+	int getNumStateValues() const;
+
+	//! Copy the scroll position and speed of every layer, so that they can be put back with restoreState().
+	/*!
+	\param pfState an array of getNumStateValues() floats to copy into.
+	*/
+	void saveState(float* pfState) const;
+
+	//! Put back the scroll positions and speeds copied by saveState(). The layers must not have changed since.
+	/*!
+	\param pfState the values copied.
+	\param iNumValues the number of values copied. Layers beyond them are left as they are.
+	*/
+	void restoreState(const float* pfState, int iNumValues);
+
+private:
+	static const unsigned int s_kiSTREAM_TILE_WIDTH = 512;
+
+	class Layer
+	{
+	public:
+		const sf::Texture* pTexture;
+		bool bOwnsTexture;
+		sf::Image* pImage;
+		std::vector<std::shared_ptr<sf::Texture> > vTiles;
+		int iWidth;
+		int iHeight;
+		float fScrollSpeed;
+		float fOffset;
+	};
+
+	void streamTiles(Layer& layer);
+	void appendStreamedLayer(const Layer& layer, RenderFrame& frame) const;
+
+	int m_iViewWidth;
+	int m_iViewHeight;
+	std::vector<Layer> m_vLayers;
+
+	/* Copying a background would mean copying its textures, which is never wanted. */
+	ParallaxBackground(const ParallaxBackground&);
+	ParallaxBackground& operator=(const ParallaxBackground&);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "Random.h"
+
+static sf::Uint32 rotateLeft(sf::Uint32 iValue, int iBits)
+{
+	return (iValue << iBits) | (iValue >> (32 - iBits));
+}
+
+/* Constructor */
+Random::Random(sf::Uint64 iSeed)
+{
+	seed(iSeed);
+}
+
+/* The seed is spread over the state with splitmix64, as xoshiro must not start from all zeros and works */
+/* best from a state whose bits are well mixed. */
+void Random::seed(sf::Uint64 iSeed)
+{
+	for (int i = 0; i < 4; i += 2)
+	{
+		iSeed += 0x9E3779B97F4A7C15ULL;
+		sf::Uint64 z = iSeed;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		z = z ^ (z >> 31);
+		m_aiState[i] = static_cast<sf::Uint32>(z);
+		m_aiState[i + 1] = static_cast<sf::Uint32>(z >> 32);
+	}
+}
+
+sf::Uint32 Random::next()
+{
+	sf::Uint32 iResult = rotateLeft(m_aiState[1] * 5, 7) * 9;
+	sf::Uint32 t = m_aiState[1] << 9;
+
+	m_aiState[2] ^= m_aiState[0];
+	m_aiState[3] ^= m_aiState[1];
+	m_aiState[1] ^= m_aiState[2];
+	m_aiState[0] ^= m_aiState[3];
+	m_aiState[2] ^= t;
+	m_aiState[3] = rotateLeft(m_aiState[3], 11);
+
+	return iResult;
+}
+
+/* Scales the random bits into the range with a multiply rather than a modulo, rejecting the few values that */
+/* would make some results more likely than others (Lemire's method). */
+int Random::getInt(int iMin, int iMax)
+{
+	if (iMax <= iMin)
+	{
+		return iMin;
+	}
+
+	sf::Uint32 iRange = static_cast<sf::Uint32>(iMax - iMin) + 1;
+	if (iRange == 0)
+	{
+		return static_cast<int>(next());
+	}
+
+	sf::Uint64 iProduct = static_cast<sf::Uint64>(next()) * iRange;
+	sf::Uint32 iLow = static_cast<sf::Uint32>(iProduct);
+	if (iLow < iRange)
+	{
+		sf::Uint32 iThreshold = (0u - iRange) % iRange;
+		while (iLow < iThreshold)
+		{
+			iProduct = static_cast<sf::Uint64>(next()) * iRange;
+			iLow = static_cast<sf::Uint32>(iProduct);
+		}
+	}
+	return iMin + static_cast<int>(iProduct >> 32);
+}
+
+/* Uses the top 24 bits, which is all a float can hold. */
+float Random::getFloat()
+{
+	return (next() >> 8) * (1.0f / 16777216.0f);
+}
+
+void Random::fill(sf::Uint32* piValues, int iCount)
+{
+	for (int i = 0; i < iCount; i++)
+	{
+		piValues[i] = next();
+	}
+}
+
+void Random::getState(State& state) const
+{
+	for (int i = 0; i < 4; i++)
+	{
+		state.aiWords[i] = m_aiState[i];
+	}
+}
+
+void Random::setState(const State& state)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		m_aiState[i] = state.aiWords[i];
+	}
+}
@@ -0,0 +1,54 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "SFML/Config.hpp"
+
+//! The Random class
+
+/*!
+A fast pseudo-random number generator (xoshiro128**) with a state of its own. Unlike rand(), each
+game has its own generator, so games on different threads neither share nor fight over one, and a
+game given the same seed makes the same random choices every time it is run.
+*/
+class Random
+{
+public:
+	//! The generator's state, as returned by getState().
+	class State
+	{
+	public:
+		sf::Uint32 aiWords[4];
+	};
+
+	//! Random constructor.
+	/*!
+	\param iSeed the seed. Any value, including 0, gives a good sequence.
+	*/
+	Random(sf::Uint64 iSeed = 0);
+
+	//! Start the sequence again from a seed.
+	void seed(sf::Uint64 iSeed);
+
+	//! Get the next 32 random bits.
+	sf::Uint32 next();
+
+	//! Get a random integer between iMin and iMax (inclusive), with every value equally likely.
+	int getInt(int iMin, int iMax);
+
+	//! Get a random number from 0 (inclusive) to 1 (exclusive).
+	float getFloat();
+
+	//! Fill an array with random bits. This gives the same values as calling next() iCount times.
+	void fill(sf::Uint32* piValues, int iCount);
+
+	//! Copy the generator's state, so that the sequence can be resumed from here with setState().
+	void getState(State& state) const;
+
+	//! Resume the sequence from a state copied by getState().
+	void setState(const State& state);
+
+private:
+	sf::Uint32 m_aiState[4];
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef RENDER_FRAME_H
+#define RENDER_FRAME_H
+
+#include "SFML/Graphics.hpp"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+//! The RenderQuad class
+
+/*!
+A textured, axis-aligned rectangle. Every sprite and background layer is drawn as one of these.
+*/
+class RenderQuad
+{
+public:
+	//! The texture to draw from.
+	const sf::Texture* pTexture;
+	//! The area of the screen to cover.
+	sf::FloatRect dest;
+	//! The area of the texture to draw, in pixels. This may run past the edges of a repeated texture.
+	sf::FloatRect source;
+	//! The colour the texture is multiplied by.
+	sf::Color colour;
+	//! An identifier that stays the same from frame to frame for the same on-screen item.
+	std::size_t iKey;
+};
+
+//! The RenderBatch class
+
+/*!
+A prebuilt list of axis-aligned quads sharing one texture, such as the glyphs of the text layer.
+The vertices are immutable: whoever owns the batch builds a new vertex list when it changes, so a
+batch can be kept by a frame (or handed to another thread) without copying it.
+*/
+class RenderBatch
+{
+public:
+	//! The texture to draw from.
+	const sf::Texture* pTexture;
+	//! The vertices, four per quad, in the order top-left, top-right, bottom-right, bottom-left.
+	std::shared_ptr<const std::vector<sf::Vertex> > pVertices;
+	//! An identifier that stays the same from frame to frame for the same batch.
+	std::size_t iKey;
+};
+
+//! The RenderFrame class
+
+/*!
+Everything needed to draw one frame, independent of how it will be drawn. The game fills one of
+these in and hands it to a Renderer. The three lists are drawn in order: background, sprites, overlays.
+*/
+class RenderFrame
+{
+public:
+	//! Background layers.
+	std::vector<RenderQuad> vBackground;
+	//! GameObjects.
+	std::vector<RenderQuad> vSprites;
+	//! HUD and text.
+	std::vector<RenderBatch> vOverlays;
+	//! Textures that might otherwise be destroyed while the frame is still waiting to be drawn.
+	std::vector<std::shared_ptr<const sf::Texture> > vResources;
+	//! The time of the oldest input event this frame is the first to show, in microseconds, or -1 if there is none.
+	sf::Int64 iInputTime;
+
+	//! RenderFrame constructor. The frame starts empty.
+	RenderFrame()
+	{
+		iInputTime = -1;
+	}
+
+	//! Empty the frame. The lists keep their memory so that refilling them does not allocate.
+	void clear()
+	{
+		vBackground.clear();
+		vSprites.clear();
+		vOverlays.clear();
+		vResources.clear();
+		iInputTime = -1;
+	}
+};
+
+//! The Renderer class
+
+/*!
+The interface for anything that can draw a RenderFrame.
+*/
+class Renderer
+{
+public:
+	virtual ~Renderer() {}
+
+	//! Draw a frame.
+	virtual void renderFrame(const RenderFrame& frame) = 0;
+
+	//! Tell the renderer that the contents of a texture have changed.
+	/*!
+	Renderers that keep their own copy of textures use this to discard it. The default does nothing.
+	*/
+	virtual void textureChanged(const sf::Texture* /*pTexture*/) {}
+};
+
+#endif
@@ -0,0 +1,202 @@
+#include "RenderThread.h"
+
+/* Constructor */
+RenderThread::RenderThread(Renderer& renderer, sf::RenderWindow* pWindow):m_Renderer(renderer)
+{
+	m_pWindow = pWindow;
+	m_pInputClock = NULL;
+	m_iLastInputTime = -1;
+	m_bFramePending = false;
+	m_bStopping = false;
+	m_iNumFramesRendered = 0;
+	m_iNumFramesDropped = 0;
+	m_iTotalRenderTime = 0;
+	m_iLastRenderTime = 0;
+	m_iTotalPresentTime = 0;
+	m_iNumLatencySamples = 0;
+	m_iTotalInputLatency = 0;
+	m_iMaxInputLatency = 0;
+}
+
+/* Destructor */
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+/* An OpenGL context can only be active on one thread at a time, so the window's is released here */
+/* and taken up again by the render thread. */
+void RenderThread::start()
+{
+	if (m_Thread.joinable())
+	{
+		return;
+	}
+
+	if (m_pWindow)
+	{
+		m_pWindow->setActive(false);
+	}
+	m_bStopping = false;
+	m_Thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+	if (!m_Thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bStopping = true;
+	}
+	m_FramePublished.notify_one();
+	m_Thread.join();
+
+	if (m_pWindow)
+	{
+		m_pWindow->setActive(true);
+	}
+}
+
+RenderFrame& RenderThread::getFrame()
+{
+	return m_Frames.getWriteBuffer();
+}
+
+/* The frame itself is passed through the triple buffer without locking. The mutex only guards the */
+/* flag the render thread sleeps on. */
+/* A frame about to be dropped takes its input time with it, so that time is passed on to this frame, which */
+/* shows the same input. If the render thread acquires the old frame in the meantime, both frames report it. */
+void RenderThread::publish()
+{
+	RenderFrame& frame = m_Frames.getWriteBuffer();
+	if (m_iLastInputTime >= 0 && m_Frames.isPending() && (frame.iInputTime < 0 || m_iLastInputTime < frame.iInputTime))
+	{
+		frame.iInputTime = m_iLastInputTime;
+	}
+	m_iLastInputTime = frame.iInputTime;
+
+	if (m_Frames.publish())
+	{
+		m_iNumFramesDropped++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bFramePending = true;
+	}
+	m_FramePublished.notify_one();
+}
+
+void RenderThread::setInputClock(const sf::Clock* pClock)
+{
+	m_pInputClock = pClock;
+}
+
+int RenderThread::getNumFramesRendered() const
+{
+	return m_iNumFramesRendered;
+}
+
+int RenderThread::getNumFramesDropped() const
+{
+	return m_iNumFramesDropped;
+}
+
+sf::Int64 RenderThread::getAverageRenderTime() const
+{
+	int iNumFrames = m_iNumFramesRendered;
+	return iNumFrames > 0 ? m_iTotalRenderTime / iNumFrames : 0;
+}
+
+sf::Int64 RenderThread::getLastRenderTime() const
+{
+	return m_iLastRenderTime;
+}
+
+sf::Int64 RenderThread::getAveragePresentTime() const
+{
+	int iNumFrames = m_iNumFramesRendered;
+	return iNumFrames > 0 ? m_iTotalPresentTime / iNumFrames : 0;
+}
+
+int RenderThread::getNumLatencySamples() const
+{
+	return m_iNumLatencySamples;
+}
+
+sf::Int64 RenderThread::getAverageInputLatency() const
+{
+	int iNumSamples = m_iNumLatencySamples;
+	return iNumSamples > 0 ? m_iTotalInputLatency / iNumSamples : 0;
+}
+
+sf::Int64 RenderThread::getMaxInputLatency() const
+{
+	return m_iMaxInputLatency;
+}
+
+/* The render thread's main loop. Sleeps until a frame is published, then draws and presents the newest one. */
+void RenderThread::run()
+{
+	if (m_pWindow)
+	{
+		m_pWindow->setActive(true);
+	}
+
+	sf::Clock clock;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			while (!m_bFramePending && !m_bStopping)
+			{
+				m_FramePublished.wait(lock);
+			}
+			if (m_bStopping)
+			{
+				break;
+			}
+			m_bFramePending = false;
+		}
+
+		if (!m_Frames.acquire())
+		{
+			continue;
+		}
+
+		clock.restart();
+		m_Renderer.renderFrame(m_Frames.getReadBuffer());
+		m_iLastRenderTime = clock.getElapsedTime().asMicroseconds();
+		m_iTotalRenderTime += m_iLastRenderTime;
+
+		if (m_pWindow)
+		{
+			clock.restart();
+			m_pWindow->display();
+			m_iTotalPresentTime += clock.getElapsedTime().asMicroseconds();
+		}
+		m_iNumFramesRendered++;
+
+		/* Only this thread writes the latency totals, so the maximum needs no compare-and-swap loop. */
+		const RenderFrame& frame = m_Frames.getReadBuffer();
+		if (m_pInputClock && frame.iInputTime >= 0)
+		{
+			sf::Int64 iLatency = m_pInputClock->getElapsedTime().asMicroseconds() - frame.iInputTime;
+			m_iTotalInputLatency += iLatency;
+			if (iLatency > m_iMaxInputLatency)
+			{
+				m_iMaxInputLatency = iLatency;
+			}
+			m_iNumLatencySamples++;
+		}
+	}
+
+	if (m_pWindow)
+	{
+		m_pWindow->setActive(false);
+	}
+}
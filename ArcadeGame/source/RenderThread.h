@@ -0,0 +1,113 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include "RenderFrame.h"
+#include "TripleBuffer.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//! The RenderThread class
+
+/*!
+Draws frames on a thread of its own, so that a slow draw or a display() call waiting for vertical sync
+never holds up the game. The game thread fills in getFrame() and calls publish(). The render thread
+sleeps until a frame is published, then draws the newest one and presents it. Frames published while
+the render thread is busy replace each other, so it never falls behind.
+
+The window's OpenGL context belongs to the render thread between start() and stop(). The game thread
+must not draw to or close the window in that time, but it should keep polling the window's events.
+
+If the game sets RenderFrame::iInputTime and the clock it measures input times with has been given to
+setInputClock(), the render thread also measures input latency: the time from an input event to the
+display() of the first frame that shows its effect.
+*/
+class RenderThread
+{
+public:
+	//! RenderThread constructor.
+	/*!
+	\param renderer the renderer that draws each frame. It is only used on the render thread.
+	\param pWindow the window to present each frame to, or NULL if the renderer does not draw to a window.
+	*/
+	RenderThread(Renderer& renderer, sf::RenderWindow* pWindow = NULL);
+
+	//! RenderThread destructor. Stops the thread if it is running.
+	~RenderThread();
+
+	//! Start the render thread.
+	void start();
+
+	//! Wait for the frame being drawn to finish, then stop the render thread and give the window back to the calling thread.
+	void stop();
+
+	//! Get the frame to fill in. Only the game thread may call this.
+	RenderFrame& getFrame();
+
+	//! Hand the frame returned by getFrame() to the render thread.
+	/*!
+	If the previous frame has not been drawn yet it is dropped, and its input time is carried over to this frame.
+	*/
+	void publish();
+
+	//! Set the clock that RenderFrame::iInputTime is measured by. Call this before start(). Latency is not measured unless it is set.
+	/*!
+	\param pClock the clock, or NULL to stop measuring latency. It must not be restarted while the render thread is running.
+	*/
+	void setInputClock(const sf::Clock* pClock);
+
+	//! Get the number of frames drawn.
+	int getNumFramesRendered() const;
+
+	//! Get the number of frames that were replaced by a newer frame before they could be drawn.
+	int getNumFramesDropped() const;
+
+	//! Get the average time taken to draw a frame, in microseconds.
+	sf::Int64 getAverageRenderTime() const;
+
+	//! Get the time taken to draw the last frame, in microseconds.
+	sf::Int64 getLastRenderTime() const;
+
+	//! Get the average time taken by display(), in microseconds. This includes any wait for vertical sync.
+	sf::Int64 getAveragePresentTime() const;
+
+	//! Get the number of frames that input latency was measured for.
+	int getNumLatencySamples() const;
+
+	//! Get the average input latency, in microseconds.
+	sf::Int64 getAverageInputLatency() const;
+
+	//! Get the longest input latency, in microseconds.
+	sf::Int64 getMaxInputLatency() const;
+
+private:
+	void run();
+
+	Renderer& m_Renderer;
+	sf::RenderWindow* m_pWindow;
+	TripleBuffer<RenderFrame> m_Frames;
+	const sf::Clock* m_pInputClock;
+	/* The input time of the last frame published. Only used by the game thread. */
+	sf::Int64 m_iLastInputTime;
+
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_FramePublished;
+	bool m_bFramePending;
+	bool m_bStopping;
+
+	std::atomic<int> m_iNumFramesRendered;
+	std::atomic<int> m_iNumFramesDropped;
+	std::atomic<sf::Int64> m_iTotalRenderTime;
+	std::atomic<sf::Int64> m_iLastRenderTime;
+	std::atomic<sf::Int64> m_iTotalPresentTime;
+	std::atomic<int> m_iNumLatencySamples;
+	std::atomic<sf::Int64> m_iTotalInputLatency;
+	std::atomic<sf::Int64> m_iMaxInputLatency;
+
+	RenderThread(const RenderThread&);
+	RenderThread& operator=(const RenderThread&);
+};
+
+#endif
@@ -0,0 +1,541 @@
+#include "ReplayFile.h"
+#include "ByteStream.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* File layout, all little-endian: */
+/*	header: "ARCR", version (4 bytes), seed (8 bytes), number of ticks (4 bytes), ticks per chunk (4 bytes), */
+/*			number of chunks (4 bytes), flags (4 bytes), offset of the index (8 bytes). The only flag is bit 0, */
+/*			set if the game moved its objects in fixed point. */
+/*	chunks: the keyframe's size and compressed size (varints, both 0 for none), the compressed keyframe, then runs of */
+/*			ticks until the end of the chunk. Each run is its length, the load level, the held keys XORed with the */
+/*			previous run's, the pressed and released keys, a bit for each key whose held fraction is not simply all */
+/*			or nothing (all varints), then one byte for each of those fractions. */
+/*	index:	the offset of every chunk (8 bytes each). A chunk ends where the next one, or the index, starts. */
+static const char s_kacMAGIC[4] = {'A', 'R', 'C', 'R'};
+static const sf::Uint32 s_kiVERSION = 2;
+static const std::size_t s_kiHEADER_SIZE = 40;
+static const sf::Uint32 s_kiFIXED_POINT_FLAG = 1;
+
+/* Matches are found through a hash of the next 4 bytes, keeping only the latest position for each hash. */
+static const std::size_t s_kiMIN_MATCH = 4;
+static const int s_kiHASH_BITS = 12;
+static const std::size_t s_kiMAX_DISTANCE = 65535;
+
+/* Writes the data as alternating literals and matches: the number of literals, the literals themselves, then */
+/* the match length (less the minimum) and how far back it starts. The last literals are not followed by a match. */
+static void compress(const std::vector<char>& vData, ByteWriter& out)
+{
+	std::vector<int> viTable(1 << s_kiHASH_BITS, -1);
+	std::size_t iSize = vData.size();
+	std::size_t iLiteralStart = 0;
+	std::size_t i = 0;
+	while (i + s_kiMIN_MATCH <= iSize)
+	{
+		sf::Uint32 iBytes;
+		memcpy(&iBytes, &vData[i], sizeof(iBytes));
+		sf::Uint32 iHash = (iBytes * 2654435761u) >> (32 - s_kiHASH_BITS);
+		int iCandidate = viTable[iHash];
+		viTable[iHash] = static_cast<int>(i);
+
+		if (iCandidate < 0 || i - iCandidate > s_kiMAX_DISTANCE || memcmp(&vData[iCandidate], &vData[i], s_kiMIN_MATCH) != 0)
+		{
+			i++;
+			continue;
+		}
+
+		std::size_t iLength = s_kiMIN_MATCH;
+		while (i + iLength < iSize && vData[iCandidate + iLength] == vData[i + iLength])
+		{
+			iLength++;
+		}
+		out.writeVarint(i - iLiteralStart);
+		out.writeBytes(&vData[0] + iLiteralStart, i - iLiteralStart);
+		out.writeVarint(iLength - s_kiMIN_MATCH);
+		out.writeVarint(i - iCandidate);
+		i += iLength;
+		iLiteralStart = i;
+	}
+	out.writeVarint(iSize - iLiteralStart);
+	out.writeBytes(&vData[0] + iLiteralStart, iSize - iLiteralStart);
+}
+
+/* Matches may overlap the bytes they produce, so they are copied a byte at a time. */
+static bool decompress(ByteReader& in, std::size_t iSize, std::vector<char>& vData)
+{
+	vData.clear();
+	vData.reserve(iSize);
+	while (true)
+	{
+		std::size_t iNumLiterals = static_cast<std::size_t>(in.readVarint());
+		const char* pLiterals = in.readBytes(iNumLiterals);
+		if (!pLiterals || iNumLiterals > iSize - vData.size())
+		{
+			return false;
+		}
+		vData.insert(vData.end(), pLiterals, pLiterals + iNumLiterals);
+		if (vData.size() == iSize)
+		{
+			return true;
+		}
+
+		std::size_t iLength = static_cast<std::size_t>(in.readVarint()) + s_kiMIN_MATCH;
+		std::size_t iDistance = static_cast<std::size_t>(in.readVarint());
+		if (!in.isValid() || iDistance == 0 || iDistance > vData.size() || iLength > iSize - vData.size())
+		{
+			return false;
+		}
+		std::size_t iFrom = vData.size() - iDistance;
+		for (std::size_t i = 0; i < iLength; i++)
+		{
+			vData.push_back(vData[iFrom + i]);
+		}
+	}
+}
+
+static bool isSameTick(const InputLog::Tick& tick1, const InputLog::Tick& tick2)
+{
+	if (tick1.iLoadLevel != tick2.iLoadLevel || tick1.input.iHeld != tick2.input.iHeld ||
+		tick1.input.iPressed != tick2.input.iPressed || tick1.input.iReleased != tick2.input.iReleased)
+	{
+		return false;
+	}
+	return memcmp(tick1.input.aiHeldFraction, tick2.input.aiHeldFraction, sizeof(tick1.input.aiHeldFraction)) == 0;
+}
+
+static void writeTicks(const InputLog& log, int iFirstTick, int iEndTick, ByteWriter& out)
+{
+	sf::Uint16 iPreviousHeld = 0;
+	int iTick = iFirstTick;
+	while (iTick < iEndTick)
+	{
+		const InputLog::Tick& tick = log.getTick(iTick);
+		int iRunLength = 1;
+		while (iTick + iRunLength < iEndTick && isSameTick(log.getTick(iTick + iRunLength), tick))
+		{
+			iRunLength++;
+		}
+
+		const InputState::Frame& frame = tick.input;
+		sf::Uint16 iPartlyHeld = 0;
+		for (int i = 0; i < InputState::NUM_KEYS; i++)
+		{
+			sf::Uint8 iWhole = (frame.iHeld >> i) & 1 ? 255 : 0;
+			if (frame.aiHeldFraction[i] != iWhole)
+			{
+				iPartlyHeld |= 1 << i;
+			}
+		}
+
+		out.writeVarint(iRunLength);
+		out.writeVarint(tick.iLoadLevel);
+		out.writeVarint(frame.iHeld ^ iPreviousHeld);
+		out.writeVarint(frame.iPressed);
+		out.writeVarint(frame.iReleased);
+		out.writeVarint(iPartlyHeld);
+		for (int i = 0; i < InputState::NUM_KEYS; i++)
+		{
+			if ((iPartlyHeld >> i) & 1)
+			{
+				out.writeUint8(frame.aiHeldFraction[i]);
+			}
+		}
+		iPreviousHeld = frame.iHeld;
+		iTick += iRunLength;
+	}
+}
+
+/* Constructor */
+ReplayFile::ReplayFile()
+{
+	m_pData = NULL;
+	m_iSize = 0;
+	m_hFile = NULL;
+	m_hMapping = NULL;
+	close();
+}
+
+/* Destructor */
+ReplayFile::~ReplayFile()
+{
+	close();
+}
+
+/* The file is built in memory and written in one go, as the index can only be written once every chunk has been. */
+bool ReplayFile::save(const InputLog& log, const std::string& sPath)
+{
+	int iInterval = log.getKeyframeInterval();
+	int iNumTicks = log.getNumTicks();
+	int iNumChunks = (iNumTicks + iInterval - 1) / iInterval;
+
+	std::vector<char> vFile;
+	ByteWriter out(vFile);
+	out.writeBytes(s_kacMAGIC, sizeof(s_kacMAGIC));
+	out.writeUint32(s_kiVERSION);
+	out.writeUint64(log.getSeed());
+	out.writeUint32(iNumTicks);
+	out.writeUint32(iInterval);
+	out.writeUint32(iNumChunks);
+	out.writeUint32(log.isFixedPoint() ? s_kiFIXED_POINT_FLAG : 0);
+	out.writeUint64(0);
+
+	std::vector<sf::Uint64> viOffsets;
+	int iKeyframe = 0;
+	for (int i = 0; i < iNumChunks; i++)
+	{
+		viOffsets.push_back(out.getSize());
+
+		int iFirstTick = i * iInterval;
+		while (iKeyframe < log.getNumKeyframes() && log.getKeyframe(iKeyframe).iTick < iFirstTick)
+		{
+			iKeyframe++;
+		}
+		if (iKeyframe < log.getNumKeyframes() && log.getKeyframe(iKeyframe).iTick == iFirstTick && !log.getKeyframe(iKeyframe).vState.empty())
+		{
+			std::vector<char> vPacked;
+			ByteWriter packer(vPacked);
+			compress(log.getKeyframe(iKeyframe).vState, packer);
+			out.writeVarint(log.getKeyframe(iKeyframe).vState.size());
+			out.writeVarint(vPacked.size());
+			out.writeBytes(&vPacked[0], vPacked.size());
+		}
+		else
+		{
+			out.writeVarint(0);
+			out.writeVarint(0);
+		}
+
+		writeTicks(log, iFirstTick, std::min(iFirstTick + iInterval, iNumTicks), out);
+	}
+
+	sf::Uint64 iIndexOffset = out.getSize();
+	for (unsigned int i = 0; i < viOffsets.size(); i++)
+	{
+		out.writeUint64(viOffsets[i]);
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		vFile[s_kiHEADER_SIZE - 8 + i] = static_cast<char>(iIndexOffset >> (8 * i));
+	}
+
+	std::ofstream file(sPath.c_str(), std::ios::binary);
+	file.write(&vFile[0], vFile.size());
+	return file.good();
+}
+
+bool ReplayFile::open(const std::string& sPath)
+{
+	close();
+	if (!mapFile(sPath))
+	{
+		close();
+		return false;
+	}
+
+	ByteReader in(m_pData, m_iSize);
+	const char* pMagic = in.readBytes(sizeof(s_kacMAGIC));
+	if (!pMagic || memcmp(pMagic, s_kacMAGIC, sizeof(s_kacMAGIC)) != 0 || in.readUint32() != s_kiVERSION)
+	{
+		close();
+		return false;
+	}
+	m_iSeed = in.readUint64();
+	sf::Uint32 iNumTicks = in.readUint32();
+	sf::Uint32 iInterval = in.readUint32();
+	sf::Uint32 iNumChunks = in.readUint32();
+	sf::Uint32 iFlags = in.readUint32();
+	sf::Uint64 iIndexOffset = in.readUint64();
+
+	/* The counts are checked against each other and the index against the size of the file, so that every */
+	/* chunk offset read later can be trusted to be inside the file. */
+	bool bValid = in.isValid() && iInterval > 0 && iNumTicks <= 0x7FFFFFFF &&
+				  iNumChunks == iNumTicks / iInterval + (iNumTicks % iInterval != 0 ? 1 : 0) &&
+				  iIndexOffset >= s_kiHEADER_SIZE && iIndexOffset <= m_iSize && (m_iSize - iIndexOffset) / 8 >= iNumChunks;
+	if (!bValid)
+	{
+		close();
+		return false;
+	}
+
+	m_iNumTicks = static_cast<int>(iNumTicks);
+	m_iKeyframeInterval = static_cast<int>(iInterval);
+	m_iNumKeyframes = static_cast<int>(iNumChunks);
+	m_bFixedPoint = (iFlags & s_kiFIXED_POINT_FLAG) != 0;
+	m_pIndex = m_pData + iIndexOffset;
+
+	sf::Uint64 iPreviousOffset = s_kiHEADER_SIZE;
+	ByteReader index(m_pIndex, m_iNumKeyframes * 8);
+	for (int i = 0; i < m_iNumKeyframes; i++)
+	{
+		sf::Uint64 iOffset = index.readUint64();
+		if (iOffset < iPreviousOffset || iOffset > iIndexOffset)
+		{
+			close();
+			return false;
+		}
+		iPreviousOffset = iOffset;
+	}
+	return true;
+}
+
+void ReplayFile::close()
+{
+#ifdef _WIN32
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (m_hFile)
+		CloseHandle(m_hFile);
+#else
+	if (m_pData)
+		munmap(const_cast<char*>(m_pData), m_iSize);
+#endif
+	m_pData = NULL;
+	m_iSize = 0;
+	m_hFile = NULL;
+	m_hMapping = NULL;
+	m_iSeed = 0;
+	m_iNumTicks = 0;
+	m_iKeyframeInterval = 1;
+	m_iNumKeyframes = 0;
+	m_bFixedPoint = false;
+	m_pIndex = NULL;
+}
+
+bool ReplayFile::isOpen() const
+{
+	return m_pData != NULL;
+}
+
+sf::Uint64 ReplayFile::getSeed() const
+{
+	return m_iSeed;
+}
+
+int ReplayFile::getNumTicks() const
+{
+	return m_iNumTicks;
+}
+
+bool ReplayFile::isFixedPoint() const
+{
+	return m_bFixedPoint;
+}
+
+int ReplayFile::getKeyframeInterval() const
+{
+	return m_iKeyframeInterval;
+}
+
+int ReplayFile::getNumKeyframes() const
+{
+	return m_iNumKeyframes;
+}
+
+int ReplayFile::getKeyframeTick(int iKeyframe) const
+{
+	return iKeyframe * m_iKeyframeInterval;
+}
+
+/* Chunks are all the same length, so no searching is needed. */
+int ReplayFile::findKeyframe(int iTick) const
+{
+	if (iTick < 0 || m_iNumKeyframes == 0)
+	{
+		return 0;
+	}
+	int iKeyframe = iTick / m_iKeyframeInterval;
+	return iKeyframe < m_iNumKeyframes ? iKeyframe : m_iNumKeyframes - 1;
+}
+
+bool ReplayFile::hasKeyframeState(int iKeyframe) const
+{
+	const char* pChunk;
+	std::size_t iChunkSize;
+	if (!getChunk(iKeyframe, pChunk, iChunkSize))
+	{
+		return false;
+	}
+	ByteReader in(pChunk, iChunkSize);
+	return in.readVarint() != 0 && in.isValid();
+}
+
+bool ReplayFile::readKeyframe(int iKeyframe, std::vector<char>& vState) const
+{
+	vState.clear();
+	const char* pChunk;
+	std::size_t iChunkSize;
+	if (!getChunk(iKeyframe, pChunk, iChunkSize))
+	{
+		return false;
+	}
+
+	ByteReader in(pChunk, iChunkSize);
+	sf::Uint64 iStateSize = in.readVarint();
+	sf::Uint64 iPackedSize = in.readVarint();
+	if (!in.isValid() || iStateSize == 0 || iPackedSize > in.getRemaining())
+	{
+		return false;
+	}
+	ByteReader packed(in.readBytes(static_cast<std::size_t>(iPackedSize)), static_cast<std::size_t>(iPackedSize));
+	return decompress(packed, static_cast<std::size_t>(iStateSize), vState) && packed.isAtEnd();
+}
+
+bool ReplayFile::readTicks(int iKeyframe, std::vector<InputLog::Tick>& vTicks) const
+{
+	vTicks.clear();
+	const char* pChunk;
+	std::size_t iChunkSize;
+	if (!getChunk(iKeyframe, pChunk, iChunkSize))
+	{
+		return false;
+	}
+
+	ByteReader in(pChunk, iChunkSize);
+	in.readVarint();
+	sf::Uint64 iPackedSize = in.readVarint();
+	if (!in.isValid() || iPackedSize > in.getRemaining())
+	{
+		return false;
+	}
+	in.readBytes(static_cast<std::size_t>(iPackedSize));
+
+	int iNumTicks = std::min(m_iKeyframeInterval, m_iNumTicks - getKeyframeTick(iKeyframe));
+	sf::Uint16 iPreviousHeld = 0;
+	while (static_cast<int>(vTicks.size()) < iNumTicks)
+	{
+		sf::Uint64 iRunLength = in.readVarint();
+		InputLog::Tick tick;
+		InputState::Frame& frame = tick.input;
+		tick.iLoadLevel = static_cast<int>(in.readVarint());
+		frame.iHeld = static_cast<sf::Uint16>(in.readVarint() ^ iPreviousHeld);
+		frame.iPressed = static_cast<sf::Uint16>(in.readVarint());
+		frame.iReleased = static_cast<sf::Uint16>(in.readVarint());
+		sf::Uint64 iPartlyHeld = in.readVarint();
+		for (int i = 0; i < InputState::NUM_KEYS; i++)
+		{
+			if ((iPartlyHeld >> i) & 1)
+				frame.aiHeldFraction[i] = in.readUint8();
+			else
+				frame.aiHeldFraction[i] = (frame.iHeld >> i) & 1 ? 255 : 0;
+		}
+
+		if (!in.isValid() || iRunLength == 0 || iRunLength > static_cast<sf::Uint64>(iNumTicks - vTicks.size()))
+		{
+			vTicks.clear();
+			return false;
+		}
+		vTicks.insert(vTicks.end(), static_cast<std::size_t>(iRunLength), tick);
+		iPreviousHeld = frame.iHeld;
+	}
+	return in.isAtEnd();
+}
+
+bool ReplayFile::readLog(InputLog& log) const
+{
+	log.clear(m_iSeed);
+	log.setKeyframeInterval(m_iKeyframeInterval);
+	log.setFixedPoint(m_bFixedPoint);
+
+	std::vector<char> vState;
+	std::vector<InputLog::Tick> vTicks;
+	for (int i = 0; i < m_iNumKeyframes; i++)
+	{
+		if (hasKeyframeState(i))
+		{
+			if (!readKeyframe(i, vState))
+			{
+				log.clear(0);
+				return false;
+			}
+			log.addKeyframe(vState);
+		}
+		if (!readTicks(i, vTicks))
+		{
+			log.clear(0);
+			return false;
+		}
+		for (unsigned int j = 0; j < vTicks.size(); j++)
+		{
+			log.addTick(vTicks[j]);
+		}
+	}
+	return true;
+}
+
+/* An empty file cannot be mapped, but could not be a valid recording anyway. */
+bool ReplayFile::mapFile(const std::string& sPath)
+{
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_hFile = hFile;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size) || size.QuadPart < static_cast<LONGLONG>(s_kiHEADER_SIZE) || size.QuadPart > 0x7FFFFFFF)
+	{
+		return false;
+	}
+	m_hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m_hMapping)
+	{
+		return false;
+	}
+	m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	m_iSize = m_pData ? static_cast<std::size_t>(size.QuadPart) : 0;
+	return m_pData != NULL;
+#else
+	int iFile = ::open(sPath.c_str(), O_RDONLY);
+	if (iFile < 0)
+	{
+		return false;
+	}
+	struct stat status;
+	if (fstat(iFile, &status) != 0 || status.st_size < static_cast<off_t>(s_kiHEADER_SIZE) || status.st_size > 0x7FFFFFFF)
+	{
+		::close(iFile);
+		return false;
+	}
+	void* pMap = mmap(NULL, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, iFile, 0);
+	/* The mapping keeps the file open by itself. */
+	::close(iFile);
+	if (pMap == MAP_FAILED)
+	{
+		return false;
+	}
+	m_pData = static_cast<const char*>(pMap);
+	m_iSize = static_cast<std::size_t>(status.st_size);
+	return true;
+#endif
+}
+
+/* The offsets were checked to be in order and inside the file by open(). */
+bool ReplayFile::getChunk(int iKeyframe, const char*& pChunk, std::size_t& iChunkSize) const
+{
+	if (!isOpen() || iKeyframe < 0 || iKeyframe >= m_iNumKeyframes)
+	{
+		return false;
+	}
+	ByteReader index(m_pIndex + iKeyframe * 8, 16);
+	sf::Uint64 iOffset = index.readUint64();
+	sf::Uint64 iEnd = iKeyframe + 1 < m_iNumKeyframes ? index.readUint64() : static_cast<sf::Uint64>(m_pIndex - m_pData);
+	pChunk = m_pData + iOffset;
+	iChunkSize = static_cast<std::size_t>(iEnd - iOffset);
+	return true;
+}
@@ -0,0 +1,115 @@
+#ifndef REPLAY_FILE_H
+#define REPLAY_FILE_H
+
+#include "InputLog.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+//! The ReplayFile class
+
+/*!
+Saves recordings to files and reads them back. A file is split into chunks of InputLog::getKeyframeInterval()
+ticks, each starting with the compressed keyframe for its first tick, followed by the chunk's input. An index
+at the end of the file gives the offset of every chunk, so any tick can be reached by restoring the keyframe of
+its chunk and running at most one chunk of input, however long the recording.
+
+Input is stored as runs of identical ticks, each written as its changes from the tick before, so a tick
+where nothing happens costs nothing and one where a key goes down costs a few bytes. Keyframes are
+compressed with a small LZ77 coder.
+
+Files are read through a memory mapping rather than copied into memory, and only the header and index are
+looked at when a file is opened, so tools can open and scan a great many recordings cheaply.
+*/
+class ReplayFile
+{
+public:
+	//! ReplayFile constructor. No file is open.
+	ReplayFile();
+
+	//! ReplayFile destructor. Closes the file.
+	~ReplayFile();
+
+	//! Save a recording to a file.
+	/*!
+	Only the log's keyframes that fall at the start of a chunk are kept.
+	\return true if the file was written.
+	*/
+	static bool save(const InputLog& log, const std::string& sPath);
+
+	//! Open a file saved by save(), closing any file already open.
+	/*!
+	\return true if the file was opened and its header and index are valid.
+	*/
+	bool open(const std::string& sPath);
+
+	//! Close the file.
+	void close();
+
+	//! Check whether a file is open.
+	bool isOpen() const;
+
+	//! Get the seed of the recorded game.
+	sf::Uint64 getSeed() const;
+
+	//! Get the number of ticks recorded.
+	int getNumTicks() const;
+
+	//! Check whether the recorded game moved its objects in fixed point, as it must when played back.
+	bool isFixedPoint() const;
+
+	//! Get the number of ticks in each chunk.
+	int getKeyframeInterval() const;
+
+	//! Get the number of chunks, i.e. of places a replay can start from.
+	int getNumKeyframes() const;
+
+	//! Get the tick a chunk starts at.
+	int getKeyframeTick(int iKeyframe) const;
+
+	//! Find the chunk a tick is in, i.e. the nearest keyframe at or before it.
+	int findKeyframe(int iTick) const;
+
+	//! Check whether a chunk has a keyframe. A recording with none still replays from the start.
+	bool hasKeyframeState(int iKeyframe) const;
+
+	//! Read the game state a chunk starts with, as written by ArcadeGame::writeState().
+	/*!
+	\return true if the keyframe was read.
+	*/
+	bool readKeyframe(int iKeyframe, std::vector<char>& vState) const;
+
+	//! Read the input of every tick in a chunk.
+	/*!
+	\return true if the ticks were read.
+	*/
+	bool readTicks(int iKeyframe, std::vector<InputLog::Tick>& vTicks) const;
+
+	//! Read the whole recording.
+	/*!
+	\return true if the recording was read. If not, the log is left empty.
+	*/
+	bool readLog(InputLog& log) const;
+
+private:
+	const char* m_pData;
+	std::size_t m_iSize;
+	/* The operating system's handles for the file and its mapping, where it needs them. */
+	void* m_hFile;
+	void* m_hMapping;
+
+	sf::Uint64 m_iSeed;
+	int m_iNumTicks;
+	int m_iKeyframeInterval;
+	int m_iNumKeyframes;
+	bool m_bFixedPoint;
+	const char* m_pIndex;
+
+	bool mapFile(const std::string& sPath);
+	bool getChunk(int iKeyframe, const char*& pChunk, std::size_t& iChunkSize) const;
+
+	ReplayFile(const ReplayFile&);
+	ReplayFile& operator=(const ReplayFile&);
+};
+
+#endif
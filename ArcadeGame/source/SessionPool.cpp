@@ -0,0 +1,132 @@
+#include "SessionPool.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+/* Constructor */
+/* A session takes far longer to step than a range takes to hand out, so even two sessions are worth splitting */
+/* and each range is a single session. */
+SessionPool::SessionPool(int iNumWorkers) : m_Jobs(iNumWorkers)
+{
+	m_Jobs.setGrainSize(1);
+	m_Jobs.setSerialThreshold(1);
+	m_bAssetsLoaded = false;
+	m_iStepTime = 0;
+	m_iMemoryPerSession = 0;
+	m_iAssetMemory = 0;
+}
+
+/* Destructor */
+SessionPool::~SessionPool()
+{
+	destroy();
+}
+
+/* Sessions are created one after another, as nothing is known of whether BaseArcade's constructor is safe to */
+/* run on several threads at once. Each runs its first restart as it is created, so it is ready to step. */
+bool SessionPool::create(int iNumSessions, sf::Uint64 iFirstSeed)
+{
+	destroy();
+	if (!m_bAssetsLoaded)
+	{
+		sf::Int64 iMemoryBefore = getProcessMemory();
+		m_bAssetsLoaded = m_Assets.load();
+		m_iAssetMemory = getProcessMemory() - iMemoryBefore;
+	}
+
+	sf::Int64 iMemoryBefore = getProcessMemory();
+	for (int i = 0; i < iNumSessions; i++)
+	{
+		m_vpSessions.push_back(new ArcadeGame(m_Window, iFirstSeed + i, m_Assets, 0));
+	}
+	m_iMemoryPerSession = iNumSessions > 0 ? (getProcessMemory() - iMemoryBefore) / iNumSessions : 0;
+	return m_bAssetsLoaded;
+}
+
+void SessionPool::destroy()
+{
+	for (unsigned int i = 0; i < m_vpSessions.size(); i++)
+	{
+		delete m_vpSessions[i];
+	}
+	m_vpSessions.clear();
+}
+
+int SessionPool::getNumSessions() const
+{
+	return static_cast<int>(m_vpSessions.size());
+}
+
+ArcadeGame& SessionPool::getSession(int iSession)
+{
+	return *m_vpSessions[iSession];
+}
+
+void SessionPool::step(const InputState* pInputs)
+{
+	sf::Clock clock;
+	forEachSession([pInputs](int iSession, ArcadeGame& game)
+	{
+		game.gameMain(pInputs[iSession]);
+	});
+	m_iStepTime = clock.getElapsedTime().asMicroseconds();
+}
+
+void SessionPool::forEachSession(const SessionFunction& function)
+{
+	std::vector<ArcadeGame*>& vpSessions = m_vpSessions;
+	m_Jobs.parallelFor(0, getNumSessions(), 0, [&vpSessions, &function](int iBegin, int iEnd)
+	{
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			function(i, *vpSessions[i]);
+		}
+	});
+}
+
+JobSystem& SessionPool::getJobSystem()
+{
+	return m_Jobs;
+}
+
+sf::Int64 SessionPool::getStepTime() const
+{
+	return m_iStepTime;
+}
+
+sf::Int64 SessionPool::getMemoryPerSession() const
+{
+	return m_iMemoryPerSession;
+}
+
+sf::Int64 SessionPool::getAssetMemory() const
+{
+	return m_iAssetMemory;
+}
+
+/* Returns the memory the process is using, as the size of its working set on Windows and its resident size elsewhere. */
+sf::Int64 SessionPool::getProcessMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return static_cast<sf::Int64>(counters.WorkingSetSize);
+	}
+	return 0;
+#else
+	sf::Int64 iSize = 0;
+	sf::Int64 iResident = 0;
+	std::ifstream statm("/proc/self/statm");
+	statm >> iSize >> iResident;
+	return iResident * sysconf(_SC_PAGESIZE);
+#endif
+}
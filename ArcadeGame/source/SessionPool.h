@@ -0,0 +1,95 @@
+#ifndef SESSION_POOL_H
+#define SESSION_POOL_H
+
+#include "ArcadeGame.h"
+#include <functional>
+#include <vector>
+
+//! The SessionPool class
+
+/*!
+Many games in one process, each a session of its own, stepped side by side on a pool of threads. Sessions
+share one set of ArcadeGame::Assets, loaded once, and one window that is never opened, so what each session
+costs is its own state: GameObjects, text, snapshots and the like. A session runs on whichever pool thread
+steps it, with no threads of its own, so a thousand sessions need no more threads than the machine has.
+
+Sessions are never drawn by the pool. The memory the process grows by as sessions are created is measured,
+so the cost of a session can be reported and the number a machine can host worked out.
+*/
+class SessionPool
+{
+public:
+	//! A function run on a session by forEachSession().
+	typedef std::function<void (int iSession, ArcadeGame& game)> SessionFunction;
+
+	//! SessionPool constructor. There are no sessions until create() is called.
+	/*!
+	\param iNumWorkers the number of worker threads to step sessions on, as for JobSystem. The default, -1,
+	uses every hardware thread.
+	*/
+	SessionPool(int iNumWorkers = -1);
+
+	//! SessionPool destructor. Destroys every session.
+	~SessionPool();
+
+	//! Create a number of sessions, replacing any there were. The assets are loaded the first time.
+	/*!
+	\param iNumSessions the number of sessions.
+	\param iFirstSeed the seed of the first session's random numbers. Each session after it gets the next seed.
+	\return true if the assets were loaded. The sessions are created either way.
+	*/
+	bool create(int iNumSessions, sf::Uint64 iFirstSeed);
+
+	//! Destroy every session.
+	void destroy();
+
+	//! Get the number of sessions.
+	int getNumSessions() const;
+
+	//! Get a session.
+	ArcadeGame& getSession(int iSession);
+
+	//! Run one tick of every session, spread across the threads.
+	/*!
+	\param pInputs the input for the tick, one for each session, in session order.
+	*/
+	void step(const InputState* pInputs);
+
+	//! Run a function on every session, spread across the threads.
+	/*!
+	The function is called once for each session, on any thread, and must only touch the session it is given.
+	It must not call back into the pool.
+	*/
+	void forEachSession(const SessionFunction& function);
+
+	//! Get the job system sessions are stepped on.
+	JobSystem& getJobSystem();
+
+	//! Get the time the last call to step() took, in microseconds.
+	sf::Int64 getStepTime() const;
+
+	//! Get how much the process grew by, in bytes, for each session made by the last call to create().
+	sf::Int64 getMemoryPerSession() const;
+
+	//! Get how much the process grew by, in bytes, while loading the shared assets.
+	sf::Int64 getAssetMemory() const;
+
+private:
+	static sf::Int64 getProcessMemory();
+
+	JobSystem m_Jobs;
+	/* Handed to every session, which BaseArcade needs, but never opened. */
+	sf::RenderWindow m_Window;
+	ArcadeGame::Assets m_Assets;
+	bool m_bAssetsLoaded;
+	std::vector<ArcadeGame*> m_vpSessions;
+
+	sf::Int64 m_iStepTime;
+	sf::Int64 m_iMemoryPerSession;
+	sf::Int64 m_iAssetMemory;
+
+	SessionPool(const SessionPool&);
+	SessionPool& operator=(const SessionPool&);
+};
+
+#endif
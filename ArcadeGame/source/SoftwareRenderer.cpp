@@ -0,0 +1,749 @@
+#include "SoftwareRenderer.h"
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define SOFTWARE_RENDERER_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Packs four bytes into a pixel so that they sit in memory in the order given, whatever the byte order of the machine. */
+static sf::Uint32 packPixel(sf::Uint8 r, sf::Uint8 g, sf::Uint8 b, sf::Uint8 a)
+{
+	sf::Uint8 acBytes[4] = {r, g, b, a};
+	sf::Uint32 iPixel;
+	memcpy(&iPixel, acBytes, 4);
+	return iPixel;
+}
+
+/* Wraps a texture coordinate into the range [0, iSize), as a repeated texture would. */
+static int wrapCoordinate(int iValue, int iSize)
+{
+	iValue %= iSize;
+	return iValue < 0 ? iValue + iSize : iValue;
+}
+
+/* Returns the texture column drawn at screen column 0 by an unscaled quad, before wrapping. */
+/* Screen column x shows texture column getSourceColumn() + x. */
+static int getSourceColumn(const sf::FloatRect& source, const sf::FloatRect& dest)
+{
+	return static_cast<int>(floor(source.left - dest.left + 0.5f));
+}
+
+/* Divides a product of two bytes by 255, rounding to nearest. Exact for every input from 0 to 255 * 255. */
+static int divideBy255(int iValue)
+{
+	iValue += 128;
+	return (iValue + (iValue >> 8)) >> 8;
+}
+
+/* Constructor */
+SoftwareRenderer::SoftwareRenderer(unsigned int iWidth, unsigned int iHeight)
+{
+	m_iWidth = iWidth;
+	m_iHeight = iHeight;
+	m_iClearColour = packPixel(0, 0, 0, 255);
+	m_vPixels.assign(iWidth * iHeight, m_iClearColour);
+	m_vBackground.assign(iWidth * iHeight, m_iClearColour);
+	m_bColourKey = false;
+	m_iColourKey = 0;
+	m_iLastRenderTime = 0;
+	m_bDirtyTracking = true;
+	m_bFullRedraw = true;
+	m_iLastBackgroundArea = 0;
+}
+
+/* Brings the background buffer up to date and works out which areas have changed since the last frame. */
+/* Each of those areas is then copied from the background buffer and the sprites and overlays are drawn */
+/* over it, in the same order as WindowRenderer, clipped to each area in turn. */
+void SoftwareRenderer::renderFrame(const RenderFrame& frame)
+{
+	m_RenderClock.restart();
+
+	m_vDirtyRects.clear();
+	bool bBackgroundChanged = updateBackground(frame);
+	if (m_bFullRedraw || !m_bDirtyTracking || bBackgroundChanged)
+	{
+		m_vDirtyRects.push_back(sf::IntRect(0, 0, m_iWidth, m_iHeight));
+	}
+	else
+	{
+		findDamage(frame);
+	}
+
+	for (unsigned int i = 0; i < m_vDirtyRects.size(); i++)
+	{
+		copyBackground(m_vDirtyRects[i]);
+		drawFrame(frame, m_vDirtyRects[i]);
+	}
+
+	m_PreviousFrame = frame;
+	m_vChangedTextures.clear();
+	m_bFullRedraw = false;
+
+	m_iLastRenderTime = m_RenderClock.getElapsedTime().asMicroseconds();
+}
+
+void SoftwareRenderer::textureChanged(const sf::Texture* pTexture)
+{
+	m_Images.erase(pTexture);
+	m_vChangedTextures.push_back(pTexture);
+}
+
+void SoftwareRenderer::registerImage(const sf::Texture* pTexture, const sf::Image& image)
+{
+	cacheImage(pTexture, image);
+	m_vChangedTextures.push_back(pTexture);
+}
+
+void SoftwareRenderer::setColourKey(sf::Color colour, bool bEnabled)
+{
+	m_bColourKey = bEnabled;
+	m_iColourKey = packPixel(colour.r, colour.g, colour.b, 0);
+	m_bFullRedraw = true;
+}
+
+void SoftwareRenderer::setDirtyTracking(bool bEnabled)
+{
+	m_bDirtyTracking = bEnabled;
+	m_bFullRedraw = true;
+}
+
+const std::vector<sf::IntRect>& SoftwareRenderer::getDirtyRects() const
+{
+	return m_vDirtyRects;
+}
+
+bool SoftwareRenderer::saveFrame(const std::string& sPath) const
+{
+	sf::Image image;
+	image.create(m_iWidth, m_iHeight, reinterpret_cast<const sf::Uint8*>(&m_vPixels[0]));
+	return image.saveToFile(sPath);
+}
+
+int SoftwareRenderer::compareWithImage(const std::string& sPath, int iTolerance) const
+{
+	sf::Image image;
+	if (!image.loadFromFile(sPath) || image.getSize().x != m_iWidth || image.getSize().y != m_iHeight)
+	{
+		return -1;
+	}
+
+	const sf::Uint8* pExpected = image.getPixelsPtr();
+	const sf::Uint8* pActual = reinterpret_cast<const sf::Uint8*>(&m_vPixels[0]);
+	int iNumDifferent = 0;
+	for (unsigned int i = 0; i < m_vPixels.size(); i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			if (abs(pExpected[i * 4 + c] - pActual[i * 4 + c]) > iTolerance)
+			{
+				iNumDifferent++;
+				break;
+			}
+		}
+	}
+	return iNumDifferent;
+}
+
+const sf::Uint32* SoftwareRenderer::getPixels() const
+{
+	return &m_vPixels[0];
+}
+
+unsigned int SoftwareRenderer::getWidth() const
+{
+	return m_iWidth;
+}
+
+unsigned int SoftwareRenderer::getHeight() const
+{
+	return m_iHeight;
+}
+
+sf::Int64 SoftwareRenderer::getLastRenderTime() const
+{
+	return m_iLastRenderTime;
+}
+
+int SoftwareRenderer::getLastBackgroundArea() const
+{
+	return m_iLastBackgroundArea;
+}
+
+/* Returns the system memory copy of a texture, reading it back from the graphics card the first time. */
+const SoftwareRenderer::CachedImage& SoftwareRenderer::getImage(const sf::Texture* pTexture)
+{
+	std::map<const sf::Texture*, CachedImage>::iterator it = m_Images.find(pTexture);
+	if (it == m_Images.end())
+	{
+		cacheImage(pTexture, pTexture->copyToImage());
+		it = m_Images.find(pTexture);
+	}
+	return it->second;
+}
+
+void SoftwareRenderer::cacheImage(const sf::Texture* pTexture, const sf::Image& image)
+{
+	CachedImage& cached = m_Images[pTexture];
+	cached.iWidth = image.getSize().x;
+	cached.iHeight = image.getSize().y;
+	cached.vPixels.resize(cached.iWidth * cached.iHeight);
+	if (!cached.vPixels.empty())
+	{
+		memcpy(&cached.vPixels[0], image.getPixelsPtr(), cached.vPixels.size() * 4);
+	}
+}
+
+/* Draws every sprite and overlay that overlaps the clip area. The background is already in place. */
+void SoftwareRenderer::drawFrame(const RenderFrame& frame, const sf::IntRect& clip)
+{
+	for (unsigned int i = 0; i < frame.vSprites.size(); i++)
+	{
+		const RenderQuad& quad = frame.vSprites[i];
+		drawQuad(m_vPixels, getImage(quad.pTexture), quad.dest, quad.source, quad.colour, clip);
+	}
+	for (unsigned int i = 0; i < frame.vOverlays.size(); i++)
+	{
+		drawBatch(frame.vOverlays[i], clip);
+	}
+}
+
+/* Clears the background buffer within the clip area and draws the background quads into it. */
+void SoftwareRenderer::drawBackground(const RenderFrame& frame, const sf::IntRect& clip)
+{
+	fillRect(m_vBackground, clip, m_iClearColour);
+	for (unsigned int i = 0; i < frame.vBackground.size(); i++)
+	{
+		const RenderQuad& quad = frame.vBackground[i];
+		drawQuad(m_vBackground, getImage(quad.pTexture), quad.dest, quad.source, quad.colour, clip);
+	}
+	m_iLastBackgroundArea += clip.width * clip.height;
+}
+
+/* Copies an area of the background buffer into the framebuffer, ready for the sprites to be drawn over it. */
+void SoftwareRenderer::copyBackground(const sf::IntRect& rect)
+{
+	for (int y = rect.top; y < rect.top + rect.height; y++)
+	{
+		memcpy(&m_vPixels[y * m_iWidth + rect.left], &m_vBackground[y * m_iWidth + rect.left], rect.width * 4);
+	}
+}
+
+/* Draws a textured, axis-aligned rectangle into a buffer the size of the framebuffer, with nearest-neighbour */
+/* sampling. Unscaled, untinted rows (sprites, glyphs and backgrounds in practice) go through blendSpan() in */
+/* runs that stop at the texture's right-hand edge, so repeated textures wrap without any per-pixel work. */
+/* Pixels are sampled from the position of the pixel within the whole quad, never from the clip area, */
+/* so drawing a quad in several clipped pieces gives exactly the same result as drawing it in one go. */
+/* Unscaled rows round the offset into the texture once and add the whole-pixel column to it, so moving */
+/* the source by any amount moves the drawn pixels by exactly the rounded difference. */
+void SoftwareRenderer::drawQuad(std::vector<sf::Uint32>& vTarget, const CachedImage& image, const sf::FloatRect& dest, const sf::FloatRect& source, sf::Color colour, const sf::IntRect& clip)
+{
+	sf::IntRect area;
+	if (image.iWidth == 0 || image.iHeight == 0 || !getPixelBounds(dest).intersects(clip, area))
+	{
+		return;
+	}
+
+	int iX0 = area.left;
+	int iY0 = area.top;
+	int iX1 = area.left + area.width;
+	int iY1 = area.top + area.height;
+
+	float fScaleX = source.width / dest.width;
+	float fScaleY = source.height / dest.height;
+	bool bUnscaled = fabs(fScaleX - 1) < 0.0001f;
+	bool bTinted = colour != sf::Color::White;
+
+	for (int y = iY0; y < iY1; y++)
+	{
+		int iSourceY = wrapCoordinate(static_cast<int>(floor(source.top + (y + 0.5f - dest.top) * fScaleY)), image.iHeight);
+		const sf::Uint32* pSourceRow = &image.vPixels[iSourceY * image.iWidth];
+		sf::Uint32* pDestRow = &vTarget[y * m_iWidth];
+
+		if (bUnscaled)
+		{
+			int iSourceX = wrapCoordinate(getSourceColumn(source, dest) + iX0, image.iWidth);
+			int x = iX0;
+			while (x < iX1)
+			{
+				int iCount = std::min(iX1 - x, image.iWidth - iSourceX);
+				if (bTinted)
+				{
+					blendSpanModulated(pDestRow + x, pSourceRow + iSourceX, iCount, colour);
+				}
+				else
+				{
+					blendSpan(pDestRow + x, pSourceRow + iSourceX, iCount);
+				}
+				x += iCount;
+				iSourceX = 0;
+			}
+		}
+		else
+		{
+			for (int x = iX0; x < iX1; x++)
+			{
+				int iSourceX = wrapCoordinate(static_cast<int>(floor(source.left + (x + 0.5f - dest.left) * fScaleX)), image.iWidth);
+				if (bTinted)
+				{
+					blendSpanModulated(pDestRow + x, pSourceRow + iSourceX, 1, colour);
+				}
+				else
+				{
+					pDestRow[x] = blendPixel(pDestRow[x], pSourceRow[iSourceX]);
+				}
+			}
+		}
+	}
+}
+
+/* Batches hold quads as four vertices each. Only the top-left and bottom-right corners are needed for axis-aligned quads. */
+void SoftwareRenderer::drawBatch(const RenderBatch& batch, const sf::IntRect& clip)
+{
+	if (!batch.pVertices)
+	{
+		return;
+	}
+
+	const std::vector<sf::Vertex>& vVertices = *batch.pVertices;
+	const CachedImage& image = getImage(batch.pTexture);
+	for (unsigned int i = 0; i + 3 < vVertices.size(); i += 4)
+	{
+		const sf::Vertex& topLeft = vVertices[i];
+		const sf::Vertex& bottomRight = vVertices[i + 2];
+		sf::FloatRect dest(topLeft.position, bottomRight.position - topLeft.position);
+		sf::FloatRect source(topLeft.texCoords, bottomRight.texCoords - topLeft.texCoords);
+		drawQuad(m_vPixels, image, dest, source, topLeft.color, clip);
+	}
+}
+
+void SoftwareRenderer::fillRect(std::vector<sf::Uint32>& vTarget, const sf::IntRect& rect, sf::Uint32 iColour)
+{
+	for (int y = rect.top; y < rect.top + rect.height; y++)
+	{
+		std::fill(vTarget.begin() + y * m_iWidth + rect.left, vTarget.begin() + y * m_iWidth + rect.left + rect.width, iColour);
+	}
+}
+
+/* Returns the pixels covered by a quad, clipped to the framebuffer. A pixel is covered if its centre is inside the quad. */
+sf::IntRect SoftwareRenderer::getPixelBounds(const sf::FloatRect& dest) const
+{
+	int iX0 = std::max(0, static_cast<int>(floor(dest.left + 0.5f)));
+	int iY0 = std::max(0, static_cast<int>(floor(dest.top + 0.5f)));
+	int iX1 = std::min(static_cast<int>(m_iWidth), static_cast<int>(floor(dest.left + dest.width + 0.5f)));
+	int iY1 = std::min(static_cast<int>(m_iHeight), static_cast<int>(floor(dest.top + dest.height + 0.5f)));
+	if (iX0 >= iX1 || iY0 >= iY1)
+	{
+		return sf::IntRect(0, 0, 0, 0);
+	}
+	return sf::IntRect(iX0, iY0, iX1 - iX0, iY1 - iY0);
+}
+
+/* Brings the background buffer up to date with the frame and returns true if any of it changed. */
+/* A background that has only scrolled sideways since the last frame is shifted in place, and only the */
+/* strip that has scrolled into view is drawn. Anything else redraws the whole background. */
+bool SoftwareRenderer::updateBackground(const RenderFrame& frame)
+{
+	sf::IntRect screen(0, 0, m_iWidth, m_iHeight);
+	m_iLastBackgroundArea = 0;
+
+	int iShift = 0;
+	if (m_bFullRedraw || !m_bDirtyTracking || !findBackgroundScroll(frame.vBackground, m_PreviousFrame.vBackground, iShift))
+	{
+		drawBackground(frame, screen);
+		return true;
+	}
+	if (iShift == 0)
+	{
+		return false;
+	}
+	if (abs(iShift) >= static_cast<int>(m_iWidth))
+	{
+		drawBackground(frame, screen);
+		return true;
+	}
+
+	int iKept = m_iWidth - abs(iShift);
+	for (unsigned int y = 0; y < m_iHeight; y++)
+	{
+		sf::Uint32* pRow = &m_vBackground[y * m_iWidth];
+		if (iShift > 0)
+		{
+			memmove(pRow, pRow + iShift, iKept * 4);
+		}
+		else
+		{
+			memmove(pRow - iShift, pRow, iKept * 4);
+		}
+	}
+	drawBackground(frame, iShift > 0 ? sf::IntRect(iKept, 0, iShift, m_iHeight) : sf::IntRect(0, 0, -iShift, m_iHeight));
+	return true;
+}
+
+/* Works out whether the background differs from the previous one only by a sideways scroll, and if so by how */
+/* many pixels. Every quad must match its predecessor apart from the left of its source rectangle, and every */
+/* quad that moved must be unscaled and span the full width of the framebuffer, and every visible quad must move */
+/* by the same whole number of pixels, once wrapped around its texture. Then each pixel of the new background is exactly the pixel */
+/* iShift columns to its right in the old one. Streamed layers, whose tiles come and go, never pass. */
+bool SoftwareRenderer::findBackgroundScroll(const std::vector<RenderQuad>& vCurrent, const std::vector<RenderQuad>& vPrevious, int& iShift)
+{
+	if (vCurrent.size() != vPrevious.size())
+	{
+		return false;
+	}
+
+	iShift = 0;
+	bool bFirst = true;
+	for (unsigned int i = 0; i < vCurrent.size(); i++)
+	{
+		const RenderQuad& quad = vCurrent[i];
+		const RenderQuad& previous = vPrevious[i];
+		if (quad.iKey != previous.iKey || quad.pTexture != previous.pTexture || quad.dest != previous.dest ||
+			quad.colour != previous.colour || quad.source.top != previous.source.top || quad.source.width != previous.source.width ||
+			quad.source.height != previous.source.height || textureHasChanged(quad.pTexture))
+		{
+			return false;
+		}
+
+		sf::IntRect bounds = getPixelBounds(quad.dest);
+		if (bounds.width == 0)
+		{
+			continue;
+		}
+
+		int iQuadShift = 0;
+		if (quad.source.left != previous.source.left)
+		{
+			const CachedImage& image = getImage(quad.pTexture);
+			if (image.iWidth == 0 || fabs(quad.source.width / quad.dest.width - 1) >= 0.0001f || bounds.left != 0 ||
+				bounds.width != static_cast<int>(m_iWidth))
+			{
+				return false;
+			}
+			iQuadShift = wrapCoordinate(getSourceColumn(quad.source, quad.dest) - getSourceColumn(previous.source, previous.dest), image.iWidth);
+			if (iQuadShift > image.iWidth / 2)
+			{
+				iQuadShift -= image.iWidth;
+			}
+		}
+
+		if (!bFirst && iQuadShift != iShift)
+		{
+			return false;
+		}
+		iShift = iQuadShift;
+		bFirst = false;
+	}
+	return true;
+}
+
+/* Compares the sprites and overlays in the frame with those in the previous frame and collects the damaged areas. */
+/* The background is handled by updateBackground(). */
+void SoftwareRenderer::findDamage(const RenderFrame& frame)
+{
+	damageQuads(frame.vSprites, m_PreviousFrame.vSprites);
+	damageBatches(frame.vOverlays, m_PreviousFrame.vOverlays);
+	mergeDirtyRects();
+}
+
+/* A quad is damaged where it is now and where it was before if it is new, has gone, or has changed in any way. */
+/* Quads that swapped drawing order with an earlier quad are treated as changed, since overlaps may now differ. */
+void SoftwareRenderer::damageQuads(const std::vector<RenderQuad>& vCurrent, const std::vector<RenderQuad>& vPrevious)
+{
+	m_vPreviousKeys.clear();
+	for (unsigned int i = 0; i < vPrevious.size(); i++)
+	{
+		m_vPreviousKeys.push_back(std::make_pair(vPrevious[i].iKey, static_cast<int>(i)));
+	}
+	std::sort(m_vPreviousKeys.begin(), m_vPreviousKeys.end());
+	m_vbMatched.assign(vPrevious.size(), false);
+
+	int iLastMatched = -1;
+	for (unsigned int i = 0; i < vCurrent.size(); i++)
+	{
+		const RenderQuad& quad = vCurrent[i];
+		int iPrevious = findPrevious(quad.iKey);
+		if (iPrevious < 0)
+		{
+			addDirtyRect(getPixelBounds(quad.dest));
+			continue;
+		}
+
+		const RenderQuad& previous = vPrevious[iPrevious];
+		if (iPrevious < iLastMatched || quad.pTexture != previous.pTexture || quad.dest != previous.dest ||
+			quad.source != previous.source || quad.colour != previous.colour || textureHasChanged(quad.pTexture))
+		{
+			addDirtyRect(getPixelBounds(quad.dest));
+			addDirtyRect(getPixelBounds(previous.dest));
+		}
+		iLastMatched = std::max(iLastMatched, iPrevious);
+	}
+
+	for (unsigned int i = 0; i < vPrevious.size(); i++)
+	{
+		if (!m_vbMatched[i])
+		{
+			addDirtyRect(getPixelBounds(vPrevious[i].dest));
+		}
+	}
+}
+
+/* Batches are compared by vertex list. Owners replace the list whenever anything in it changes, so an */
+/* unchanged pointer means an unchanged batch and no vertices need to be looked at. */
+void SoftwareRenderer::damageBatches(const std::vector<RenderBatch>& vCurrent, const std::vector<RenderBatch>& vPrevious)
+{
+	m_vPreviousKeys.clear();
+	for (unsigned int i = 0; i < vPrevious.size(); i++)
+	{
+		m_vPreviousKeys.push_back(std::make_pair(vPrevious[i].iKey, static_cast<int>(i)));
+	}
+	std::sort(m_vPreviousKeys.begin(), m_vPreviousKeys.end());
+	m_vbMatched.assign(vPrevious.size(), false);
+
+	int iLastMatched = -1;
+	for (unsigned int i = 0; i < vCurrent.size(); i++)
+	{
+		const RenderBatch& batch = vCurrent[i];
+		int iPrevious = findPrevious(batch.iKey);
+		if (iPrevious < 0)
+		{
+			damageBatchBounds(*batch.pVertices);
+			continue;
+		}
+
+		const RenderBatch& previous = vPrevious[iPrevious];
+		if (iPrevious < iLastMatched || batch.pTexture != previous.pTexture || textureHasChanged(batch.pTexture))
+		{
+			damageBatchBounds(*batch.pVertices);
+			damageBatchBounds(*previous.pVertices);
+		}
+		else if (batch.pVertices != previous.pVertices)
+		{
+			damageBatchChanges(*batch.pVertices, *previous.pVertices);
+		}
+		iLastMatched = std::max(iLastMatched, iPrevious);
+	}
+
+	for (unsigned int i = 0; i < vPrevious.size(); i++)
+	{
+		if (!m_vbMatched[i])
+		{
+			damageBatchBounds(*vPrevious[i].pVertices);
+		}
+	}
+}
+
+/* When a vertex list has been replaced with one of the same length (e.g. a score changing from 120 to 140), */
+/* only the quads that differ are damaged. Otherwise the whole of both lists is. */
+void SoftwareRenderer::damageBatchChanges(const std::vector<sf::Vertex>& vCurrent, const std::vector<sf::Vertex>& vPrevious)
+{
+	if (vCurrent.size() != vPrevious.size())
+	{
+		damageBatchBounds(vCurrent);
+		damageBatchBounds(vPrevious);
+		return;
+	}
+
+	for (unsigned int i = 0; i + 3 < vCurrent.size(); i += 4)
+	{
+		bool bChanged = false;
+		for (unsigned int j = i; j < i + 4 && !bChanged; j++)
+		{
+			bChanged = vCurrent[j].position != vPrevious[j].position || vCurrent[j].texCoords != vPrevious[j].texCoords ||
+				vCurrent[j].color != vPrevious[j].color;
+		}
+		if (bChanged)
+		{
+			addDirtyRect(getPixelBounds(sf::FloatRect(vCurrent[i].position, vCurrent[i + 2].position - vCurrent[i].position)));
+			addDirtyRect(getPixelBounds(sf::FloatRect(vPrevious[i].position, vPrevious[i + 2].position - vPrevious[i].position)));
+		}
+	}
+}
+
+/* Damages the area covered by every quad in a vertex list. */
+void SoftwareRenderer::damageBatchBounds(const std::vector<sf::Vertex>& vVertices)
+{
+	for (unsigned int i = 0; i + 3 < vVertices.size(); i += 4)
+	{
+		addDirtyRect(getPixelBounds(sf::FloatRect(vVertices[i].position, vVertices[i + 2].position - vVertices[i].position)));
+	}
+}
+
+/* Returns the index of the first unmatched item in the previous frame with the given key, and marks it as matched. */
+/* Returns -1 if there is none. */
+int SoftwareRenderer::findPrevious(std::size_t iKey)
+{
+	std::vector<std::pair<std::size_t, int> >::const_iterator it = std::lower_bound(m_vPreviousKeys.begin(), m_vPreviousKeys.end(), std::make_pair(iKey, -1));
+	for (; it != m_vPreviousKeys.end() && it->first == iKey; ++it)
+	{
+		if (!m_vbMatched[it->second])
+		{
+			m_vbMatched[it->second] = true;
+			return it->second;
+		}
+	}
+	return -1;
+}
+
+bool SoftwareRenderer::textureHasChanged(const sf::Texture* pTexture) const
+{
+	return std::find(m_vChangedTextures.begin(), m_vChangedTextures.end(), pTexture) != m_vChangedTextures.end();
+}
+
+void SoftwareRenderer::addDirtyRect(const sf::IntRect& rect)
+{
+	if (rect.width > 0 && rect.height > 0)
+	{
+		m_vDirtyRects.push_back(rect);
+	}
+}
+
+/* Merges rectangles that overlap or nearly touch, so that neighbouring glyphs and sprites are redrawn */
+/* together and no pixel is drawn twice. If the result is still fragmented, or covers most of the */
+/* framebuffer anyway, the whole framebuffer is redrawn instead. */
+void SoftwareRenderer::mergeDirtyRects()
+{
+	bool bMerged = true;
+	while (bMerged)
+	{
+		bMerged = false;
+		for (unsigned int i = 0; i < m_vDirtyRects.size(); i++)
+		{
+			sf::IntRect expanded(m_vDirtyRects[i].left - s_kiMERGE_DISTANCE, m_vDirtyRects[i].top - s_kiMERGE_DISTANCE,
+								 m_vDirtyRects[i].width + s_kiMERGE_DISTANCE * 2, m_vDirtyRects[i].height + s_kiMERGE_DISTANCE * 2);
+			for (unsigned int j = i + 1; j < m_vDirtyRects.size(); j++)
+			{
+				if (expanded.intersects(m_vDirtyRects[j]))
+				{
+					const sf::IntRect& a = m_vDirtyRects[i];
+					const sf::IntRect& b = m_vDirtyRects[j];
+					int iLeft = std::min(a.left, b.left);
+					int iTop = std::min(a.top, b.top);
+					int iRight = std::max(a.left + a.width, b.left + b.width);
+					int iBottom = std::max(a.top + a.height, b.top + b.height);
+					m_vDirtyRects[i] = sf::IntRect(iLeft, iTop, iRight - iLeft, iBottom - iTop);
+					m_vDirtyRects.erase(m_vDirtyRects.begin() + j);
+					bMerged = true;
+					break;
+				}
+			}
+		}
+	}
+
+	int iArea = 0;
+	for (unsigned int i = 0; i < m_vDirtyRects.size(); i++)
+	{
+		iArea += m_vDirtyRects[i].width * m_vDirtyRects[i].height;
+	}
+	if (static_cast<int>(m_vDirtyRects.size()) > s_kiMAX_DIRTY_RECTS || iArea > static_cast<int>(m_iWidth * m_iHeight) * 3 / 4)
+	{
+		m_vDirtyRects.clear();
+		m_vDirtyRects.push_back(sf::IntRect(0, 0, m_iWidth, m_iHeight));
+	}
+}
+
+/* Blends a run of source pixels over the framebuffer: dest = source * a + dest * (1 - a) on every channel, */
+/* which is what the graphics card does with SFML's default blend mode. With SSE2 four pixels are blended at */
+/* once, with early outs for groups that are fully transparent or fully opaque. */
+void SoftwareRenderer::blendSpan(sf::Uint32* pDest, const sf::Uint32* pSource, int iCount) const
+{
+	int i = 0;
+
+#ifdef SOFTWARE_RENDERER_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(packPixel(0, 0, 0, 255)));
+	const __m128i rgbMask = _mm_set1_epi32(static_cast<int>(packPixel(255, 255, 255, 0)));
+	const __m128i colourKey = _mm_set1_epi32(static_cast<int>(m_iColourKey));
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i half = _mm_set1_epi16(128);
+
+	for (; i + 4 <= iCount; i += 4)
+	{
+		__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+		__m128i alpha = _mm_and_si128(source, alphaMask);
+		__m128i keyed = m_bColourKey ? _mm_cmpeq_epi32(_mm_and_si128(source, rgbMask), colourKey) : zero;
+		__m128i transparent = _mm_or_si128(_mm_cmpeq_epi32(alpha, zero), keyed);
+
+		if (_mm_movemask_epi8(transparent) == 0xFFFF)
+		{
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF && _mm_movemask_epi8(keyed) == 0)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), source);
+			continue;
+		}
+
+		__m128i dest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDest + i));
+
+		/* Widen to 16 bits per channel, two pixels per register, and broadcast each pixel's alpha across its channels. */
+		__m128i sourceLo = _mm_unpacklo_epi8(source, zero);
+		__m128i sourceHi = _mm_unpackhi_epi8(source, zero);
+		__m128i destLo = _mm_unpacklo_epi8(dest, zero);
+		__m128i destHi = _mm_unpackhi_epi8(dest, zero);
+		__m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourceLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourceHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128i blendLo = _mm_add_epi16(_mm_mullo_epi16(sourceLo, alphaLo), _mm_mullo_epi16(destLo, _mm_sub_epi16(max, alphaLo)));
+		__m128i blendHi = _mm_add_epi16(_mm_mullo_epi16(sourceHi, alphaHi), _mm_mullo_epi16(destHi, _mm_sub_epi16(max, alphaHi)));
+		blendLo = _mm_add_epi16(blendLo, half);
+		blendHi = _mm_add_epi16(blendHi, half);
+		blendLo = _mm_srli_epi16(_mm_add_epi16(blendLo, _mm_srli_epi16(blendLo, 8)), 8);
+		blendHi = _mm_srli_epi16(_mm_add_epi16(blendHi, _mm_srli_epi16(blendHi, 8)), 8);
+
+		__m128i result = _mm_packus_epi16(blendLo, blendHi);
+		result = _mm_or_si128(_mm_and_si128(keyed, dest), _mm_andnot_si128(keyed, result));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), result);
+	}
+#endif
+
+	for (; i < iCount; i++)
+	{
+		pDest[i] = blendPixel(pDest[i], pSource[i]);
+	}
+}
+
+/* The tinted path multiplies each source pixel by the colour first. Only text that is not white uses this. */
+void SoftwareRenderer::blendSpanModulated(sf::Uint32* pDest, const sf::Uint32* pSource, int iCount, sf::Color colour) const
+{
+	for (int i = 0; i < iCount; i++)
+	{
+		sf::Uint8 acSource[4];
+		memcpy(acSource, &pSource[i], 4);
+		sf::Uint32 iTinted = packPixel(
+			static_cast<sf::Uint8>(divideBy255(acSource[0] * colour.r)),
+			static_cast<sf::Uint8>(divideBy255(acSource[1] * colour.g)),
+			static_cast<sf::Uint8>(divideBy255(acSource[2] * colour.b)),
+			static_cast<sf::Uint8>(divideBy255(acSource[3] * colour.a)));
+		pDest[i] = blendPixel(pDest[i], iTinted);
+	}
+}
+
+/* Scalar version of the blend in blendSpan(), used for the pixels left over after the SIMD loop. */
+sf::Uint32 SoftwareRenderer::blendPixel(sf::Uint32 iDest, sf::Uint32 iSource) const
+{
+	sf::Uint8 acSource[4];
+	sf::Uint8 acDest[4];
+	memcpy(acSource, &iSource, 4);
+	memcpy(acDest, &iDest, 4);
+
+	int iAlpha = acSource[3];
+	if (iAlpha == 0 || (m_bColourKey && packPixel(acSource[0], acSource[1], acSource[2], 0) == m_iColourKey))
+	{
+		return iDest;
+	}
+	if (iAlpha == 255)
+	{
+		return iSource;
+	}
+
+	for (int c = 0; c < 4; c++)
+	{
+		acDest[c] = static_cast<sf::Uint8>(divideBy255(acSource[c] * iAlpha + acDest[c] * (255 - iAlpha)));
+	}
+	memcpy(&iDest, acDest, 4);
+	return iDest;
+}
@@ -0,0 +1,156 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "RenderFrame.h"
+#include <map>
+#include <utility>
+#include <string>
+#include <vector>
+
+//! The SoftwareRenderer class
+
+/*!
+Draws frames into an RGBA framebuffer in system memory, without a graphics card or a display.
+Alpha blending and colour-key masking are done four pixels at a time with SSE2 where available.
+Frames can be saved as PNG files or compared against previously saved ones, which makes this the
+renderer for headless benchmarks, golden-image tests and frame capture on servers.
+
+Textures are copied into system memory the first time they are drawn. Call textureChanged() (or
+registerImage()) whenever a texture is reloaded so that the copy is refreshed.
+
+The renderer itself never touches the graphics card, but the game it draws still does: GameObjects take
+their size from an sf::Texture, so the game loads its assets into textures even when nothing is shown, and
+SFML needs an OpenGL context for that. SFML makes one itself on a hidden window. A software OpenGL driver
+will do, so no GPU is needed, but on Linux the hidden window needs an X display, e.g. one run by Xvfb.
+
+The background is drawn into a buffer of its own and copied under the sprites. When it has only
+scrolled sideways since the last frame, that buffer is shifted along in place and only the strip that
+has scrolled into view is drawn, so a scrolling background costs two copies of the screen rather than
+a clear and a blend of every pixel. getLastBackgroundArea() gives the number of background pixels drawn.
+
+Each frame is compared with the one before it, item by item, using the keys of its quads and
+batches. Only the areas covered by sprites and overlays that were added, removed, moved or changed
+are copied from the background buffer and drawn again. getDirtyRects() returns those areas so that
+frames can be streamed or recorded as updates rather than as whole images. A scrolling background
+changes every pixel, so it makes the whole framebuffer dirty even though little of it is drawn.
+*/
+class SoftwareRenderer : public Renderer
+{
+public:
+	//! SoftwareRenderer constructor.
+	/*!
+	\param iWidth the width of the framebuffer.
+	\param iHeight the height of the framebuffer.
+	*/
+	SoftwareRenderer(unsigned int iWidth, unsigned int iHeight);
+
+	void renderFrame(const RenderFrame& frame);
+	void textureChanged(const sf::Texture* pTexture);
+
+	//! Supply the system memory copy of a texture directly, instead of reading it back from the graphics card.
+	void registerImage(const sf::Texture* pTexture, const sf::Image& image);
+
+	//! Set the colour that is treated as transparent when drawing.
+	/*!
+	This mirrors BaseArcade::setAlphaMaskColour(). Only the red, green and blue components are compared.
+	\param colour the colour key.
+	\param bEnabled set to false to turn colour keying off. The default value is true.
+	*/
+	void setColourKey(sf::Color colour, bool bEnabled = true);
+
+	//! Save the last frame drawn.
+	/*!
+	\param sPath the path and filename. The format is chosen from the extension, e.g. ".png".
+	\return true if the file was written.
+	*/
+	bool saveFrame(const std::string& sPath) const;
+
+	//! Compare the last frame drawn with an image file.
+	/*!
+	\param sPath the path and filename of the image to compare against.
+	\param iTolerance the largest difference allowed in any one colour component. The default is 0.
+	\return the number of pixels that differ, or -1 if the image could not be loaded or is a different size.
+	*/
+	int compareWithImage(const std::string& sPath, int iTolerance = 0) const;
+
+	//! Turn dirty-rectangle tracking on or off. It is on by default.
+	/*!
+	\param bEnabled set to false to redraw the whole framebuffer every frame. The default value is true.
+	*/
+	void setDirtyTracking(bool bEnabled = true);
+
+	//! Get the areas of the framebuffer redrawn by the last frame. This is empty if nothing changed.
+	const std::vector<sf::IntRect>& getDirtyRects() const;
+
+	//! Get the framebuffer. Each pixel holds its red, green, blue and alpha bytes in that order in memory.
+	const sf::Uint32* getPixels() const;
+
+	//! Get the width of the framebuffer.
+	unsigned int getWidth() const;
+
+	//! Get the height of the framebuffer.
+	unsigned int getHeight() const;
+
+	//! Get the time taken to draw the last frame, in microseconds.
+	sf::Int64 getLastRenderTime() const;
+
+	//! Get the number of background pixels drawn by the last frame. A scroll only draws the strip scrolled into view.
+	int getLastBackgroundArea() const;
+
+private:
+	static const int s_kiMAX_DIRTY_RECTS = 16;
+	static const int s_kiMERGE_DISTANCE = 8;
+
+	class CachedImage
+	{
+	public:
+		int iWidth;
+		int iHeight;
+		std::vector<sf::Uint32> vPixels;
+	};
+
+	const CachedImage& getImage(const sf::Texture* pTexture);
+	void cacheImage(const sf::Texture* pTexture, const sf::Image& image);
+	void drawFrame(const RenderFrame& frame, const sf::IntRect& clip);
+	void drawBackground(const RenderFrame& frame, const sf::IntRect& clip);
+	void copyBackground(const sf::IntRect& rect);
+	void drawQuad(std::vector<sf::Uint32>& vTarget, const CachedImage& image, const sf::FloatRect& dest, const sf::FloatRect& source, sf::Color colour, const sf::IntRect& clip);
+	void drawBatch(const RenderBatch& batch, const sf::IntRect& clip);
+	void fillRect(std::vector<sf::Uint32>& vTarget, const sf::IntRect& rect, sf::Uint32 iColour);
+	sf::IntRect getPixelBounds(const sf::FloatRect& dest) const;
+	bool updateBackground(const RenderFrame& frame);
+	bool findBackgroundScroll(const std::vector<RenderQuad>& vCurrent, const std::vector<RenderQuad>& vPrevious, int& iShift);
+	void findDamage(const RenderFrame& frame);
+	void damageQuads(const std::vector<RenderQuad>& vCurrent, const std::vector<RenderQuad>& vPrevious);
+	void damageBatches(const std::vector<RenderBatch>& vCurrent, const std::vector<RenderBatch>& vPrevious);
+	void damageBatchChanges(const std::vector<sf::Vertex>& vCurrent, const std::vector<sf::Vertex>& vPrevious);
+	void damageBatchBounds(const std::vector<sf::Vertex>& vVertices);
+	int findPrevious(std::size_t iKey);
+	bool textureHasChanged(const sf::Texture* pTexture) const;
+	void addDirtyRect(const sf::IntRect& rect);
+	void mergeDirtyRects();
+	void blendSpan(sf::Uint32* pDest, const sf::Uint32* pSource, int iCount) const;
+	void blendSpanModulated(sf::Uint32* pDest, const sf::Uint32* pSource, int iCount, sf::Color colour) const;
+	sf::Uint32 blendPixel(sf::Uint32 iDest, sf::Uint32 iSource) const;
+
+	unsigned int m_iWidth;
+	unsigned int m_iHeight;
+	std::vector<sf::Uint32> m_vPixels;
+	std::vector<sf::Uint32> m_vBackground;
+	std::map<const sf::Texture*, CachedImage> m_Images;
+	bool m_bColourKey;
+	sf::Uint32 m_iColourKey;
+	sf::Uint32 m_iClearColour;
+	bool m_bDirtyTracking;
+	bool m_bFullRedraw;
+	RenderFrame m_PreviousFrame;
+	std::vector<sf::IntRect> m_vDirtyRects;
+	std::vector<const sf::Texture*> m_vChangedTextures;
+	std::vector<std::pair<std::size_t, int> > m_vPreviousKeys;
+	std::vector<bool> m_vbMatched;
+	sf::Clock m_RenderClock;
+	sf::Int64 m_iLastRenderTime;
+	int m_iLastBackgroundArea;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+
+//! The SpscQueue class
+
+/*!
+A fixed-size first-in first-out queue for passing values from one producer thread to one consumer
+thread without locks. Neither push() nor pop() ever blocks or allocates; push() fails when the queue
+is full and pop() fails when it is empty.
+\tparam T the type of value queued. It must be copyable.
+\tparam N the capacity of the queue. It must be a power of two.
+*/
+template <class T, unsigned int N>
+class SpscQueue
+{
+public:
+	//! SpscQueue constructor. The queue starts empty.
+	SpscQueue()
+	{
+		m_iHead = 0;
+		m_iTail = 0;
+	}
+
+	//! Add a value to the back of the queue. Only the producer thread may call this.
+	/*!
+	\return false if the queue was full, in which case nothing is added.
+	*/
+	bool push(const T& value)
+	{
+		unsigned int iTail = m_iTail.load(std::memory_order_relaxed);
+		if (iTail - m_iHead.load(std::memory_order_acquire) == N)
+		{
+			return false;
+		}
+		m_aValues[iTail & (N - 1)] = value;
+		m_iTail.store(iTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//! Take the value at the front of the queue. Only the consumer thread may call this.
+	/*!
+	\return false if the queue was empty, in which case value is not changed.
+	*/
+	bool pop(T& value)
+	{
+		unsigned int iHead = m_iHead.load(std::memory_order_relaxed);
+		if (iHead == m_iTail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		value = m_aValues[iHead & (N - 1)];
+		m_iHead.store(iHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	//! Check whether the queue is empty. The answer may be out of date by the time it is used by the other thread.
+	bool isEmpty() const
+	{
+		return m_iHead.load(std::memory_order_acquire) == m_iTail.load(std::memory_order_acquire);
+	}
+
+private:
+	T m_aValues[N];
+	/* The counters only ever increase, and wrap around safely as the capacity divides 2^32. */
+	/* They are kept on separate cache lines so the two threads do not share one. */
+	std::atomic<unsigned int> m_iHead;
+	char m_acPadding[64];
+	std::atomic<unsigned int> m_iTail;
+
+	SpscQueue(const SpscQueue&);
+	SpscQueue& operator=(const SpscQueue&);
+};
+
+#endif
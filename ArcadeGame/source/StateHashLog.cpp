@@ -0,0 +1,200 @@
+#include "StateHashLog.h"
+#include "ByteStream.h"
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+/* File layout, all little-endian: "ARCH", version (4 bytes), the number of type names (varint) and each name */
+/* (a string), then the number of ticks (varint) and for each tick its number (varint), its hash (8 bytes) and */
+/* the number of objects (varint), followed by each object's type (varint), hash (8 bytes) and position (2 floats). */
+static const char s_kacMAGIC[4] = {'A', 'R', 'C', 'H'};
+static const sf::Uint32 s_kiVERSION = 1;
+/* The fewest bytes a tick and an object can take, used to reject counts larger than the file could hold. */
+static const std::size_t s_kiMIN_TICK_SIZE = 10;
+static const std::size_t s_kiMIN_OBJECT_SIZE = 17;
+
+/* Constructor */
+StateHashLog::StateHashLog()
+{
+}
+
+void StateHashLog::clear()
+{
+	m_vTicks.clear();
+	m_vObjects.clear();
+	m_vsTypeNames.clear();
+}
+
+void StateHashLog::addTick(int iTick, ArcadeGame& game)
+{
+	Tick tick;
+	tick.iTick = iTick;
+	tick.iHash = game.hashState();
+	tick.iFirstObject = static_cast<int>(m_vObjects.size());
+	tick.iNumObjects = static_cast<int>(game.getObjectHashes().size());
+	m_vTicks.push_back(tick);
+
+	const std::vector<ArcadeGame::ObjectHash>& vObjectHashes = game.getObjectHashes();
+	for (unsigned int i = 0; i < vObjectHashes.size(); i++)
+	{
+		Object object;
+		object.iType = findType(vObjectHashes[i].sType);
+		object.iHash = vObjectHashes[i].iHash;
+		object.position = vObjectHashes[i].position;
+		m_vObjects.push_back(object);
+	}
+}
+
+int StateHashLog::getNumTicks() const
+{
+	return static_cast<int>(m_vTicks.size());
+}
+
+const StateHashLog::Tick& StateHashLog::getTick(int iIndex) const
+{
+	return m_vTicks[iIndex];
+}
+
+const StateHashLog::Object& StateHashLog::getObject(int iIndex) const
+{
+	return m_vObjects[iIndex];
+}
+
+const std::vector<std::string>& StateHashLog::getTypeNames() const
+{
+	return m_vsTypeNames;
+}
+
+/* Both logs are in tick order, so they are walked side by side, skipping ticks only one of them has. */
+bool StateHashLog::findDivergence(const StateHashLog& a, const StateHashLog& b, int& iIndexA, int& iIndexB)
+{
+	int i = 0;
+	int j = 0;
+	while (i < a.getNumTicks() && j < b.getNumTicks())
+	{
+		if (a.m_vTicks[i].iTick < b.m_vTicks[j].iTick)
+		{
+			i++;
+		}
+		else if (a.m_vTicks[i].iTick > b.m_vTicks[j].iTick)
+		{
+			j++;
+		}
+		else if (a.m_vTicks[i].iHash != b.m_vTicks[j].iHash)
+		{
+			iIndexA = i;
+			iIndexB = j;
+			return true;
+		}
+		else
+		{
+			i++;
+			j++;
+		}
+	}
+	return false;
+}
+
+bool StateHashLog::save(const std::string& sPath) const
+{
+	std::vector<char> vFile;
+	ByteWriter out(vFile);
+	out.writeBytes(s_kacMAGIC, sizeof(s_kacMAGIC));
+	out.writeUint32(s_kiVERSION);
+
+	out.writeVarint(m_vsTypeNames.size());
+	for (unsigned int i = 0; i < m_vsTypeNames.size(); i++)
+	{
+		out.writeString(m_vsTypeNames[i]);
+	}
+
+	out.writeVarint(m_vTicks.size());
+	for (unsigned int i = 0; i < m_vTicks.size(); i++)
+	{
+		const Tick& tick = m_vTicks[i];
+		out.writeVarint(tick.iTick);
+		out.writeUint64(tick.iHash);
+		out.writeVarint(tick.iNumObjects);
+		for (int j = tick.iFirstObject; j < tick.iFirstObject + tick.iNumObjects; j++)
+		{
+			out.writeVarint(m_vObjects[j].iType);
+			out.writeUint64(m_vObjects[j].iHash);
+			out.writeFloat(m_vObjects[j].position.x);
+			out.writeFloat(m_vObjects[j].position.y);
+		}
+	}
+
+	std::ofstream file(sPath.c_str(), std::ios::binary);
+	file.write(&vFile[0], vFile.size());
+	return file.good();
+}
+
+bool StateHashLog::load(const std::string& sPath)
+{
+	clear();
+	std::ifstream file(sPath.c_str(), std::ios::binary);
+	std::vector<char> vFile((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (vFile.empty())
+	{
+		return false;
+	}
+
+	ByteReader in(&vFile[0], vFile.size());
+	const char* pMagic = in.readBytes(sizeof(s_kacMAGIC));
+	if (!pMagic || memcmp(pMagic, s_kacMAGIC, sizeof(s_kacMAGIC)) != 0 || in.readUint32() != s_kiVERSION)
+	{
+		return false;
+	}
+
+	sf::Uint64 iNumTypes = in.readVarint();
+	for (sf::Uint64 i = 0; i < iNumTypes && in.isValid(); i++)
+	{
+		m_vsTypeNames.push_back(in.readString());
+	}
+
+	sf::Uint64 iNumTicks = in.readVarint();
+	bool bValid = in.isValid() && iNumTicks <= in.getRemaining() / s_kiMIN_TICK_SIZE;
+	for (sf::Uint64 i = 0; i < iNumTicks && bValid; i++)
+	{
+		Tick tick;
+		tick.iTick = static_cast<int>(in.readVarint());
+		tick.iHash = in.readUint64();
+		sf::Uint64 iNumObjects = in.readVarint();
+		bValid = in.isValid() && iNumObjects <= in.getRemaining() / s_kiMIN_OBJECT_SIZE;
+		tick.iFirstObject = static_cast<int>(m_vObjects.size());
+		tick.iNumObjects = static_cast<int>(iNumObjects);
+		for (sf::Uint64 j = 0; j < iNumObjects && bValid; j++)
+		{
+			Object object;
+			sf::Uint64 iType = in.readVarint();
+			object.iType = static_cast<int>(iType);
+			object.iHash = in.readUint64();
+			object.position.x = in.readFloat();
+			object.position.y = in.readFloat();
+			bValid = in.isValid() && iType < m_vsTypeNames.size();
+			m_vObjects.push_back(object);
+		}
+		m_vTicks.push_back(tick);
+	}
+
+	if (!bValid || !in.isAtEnd())
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+/* There are only a handful of types, so they are looked up by going through the list. */
+int StateHashLog::findType(const char* sType)
+{
+	for (unsigned int i = 0; i < m_vsTypeNames.size(); i++)
+	{
+		if (m_vsTypeNames[i] == sType)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	m_vsTypeNames.push_back(sType);
+	return static_cast<int>(m_vsTypeNames.size()) - 1;
+}
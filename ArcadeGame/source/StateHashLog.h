@@ -0,0 +1,95 @@
+#ifndef STATE_HASH_LOG_H
+#define STATE_HASH_LOG_H
+
+#include "ArcadeGame.h"
+#include <string>
+#include <vector>
+
+//! The StateHashLog class
+
+/*!
+The state hash of every tick of a run, as found by ArcadeGame::hashState(), along with the hash and
+position of each GameObject. Two runs that should be identical, e.g. the same recording played back by
+two builds of the game, can be checked against each other: the first tick whose hashes differ is where
+they parted, and the objects whose hashes appear in only one of the runs at that tick are what differs.
+
+Logs are saved to and loaded from files, so a run can be checked against one made earlier or elsewhere.
+*/
+class StateHashLog
+{
+public:
+	//! One GameObject in a tick.
+	class Object
+	{
+	public:
+		//! The object's type, as an index into getTypeNames().
+		int iType;
+		sf::Uint64 iHash;
+		sf::Vector2f position;
+	};
+
+	//! One tick.
+	class Tick
+	{
+	public:
+		int iTick;
+		sf::Uint64 iHash;
+		//! The tick's objects, as a range of getObject().
+		int iFirstObject;
+		int iNumObjects;
+	};
+
+	//! StateHashLog constructor. The log starts empty.
+	StateHashLog();
+
+	//! Empty the log.
+	void clear();
+
+	//! Add the hashes of a game just after it has run a tick.
+	/*!
+	\param iTick the number of the tick, counting from the start of the game.
+	\param game the game. Its hashState() is called.
+	*/
+	void addTick(int iTick, ArcadeGame& game);
+
+	//! Get the number of ticks logged.
+	int getNumTicks() const;
+
+	//! Get a logged tick. Ticks are in the order they were added.
+	const Tick& getTick(int iIndex) const;
+
+	//! Get an object of a logged tick.
+	const Object& getObject(int iIndex) const;
+
+	//! Get the name of each type of object seen.
+	const std::vector<std::string>& getTypeNames() const;
+
+	//! Find the first tick that two logs both have and whose hashes differ.
+	/*!
+	\param iIndexA set to the index of the tick in log a, if one is found.
+	\param iIndexB set to the index of the tick in log b, if one is found.
+	\return true if a tick was found, false if the ticks the logs have in common all match.
+	*/
+	static bool findDivergence(const StateHashLog& a, const StateHashLog& b, int& iIndexA, int& iIndexB);
+
+	//! Save the log to a file.
+	/*!
+	\return true if the file was written.
+	*/
+	bool save(const std::string& sPath) const;
+
+	//! Replace the log with one saved by save().
+	/*!
+	\return true if the file was read. If not, the log is left empty.
+	*/
+	bool load(const std::string& sPath);
+
+private:
+	int findType(const char* sType);
+
+	std::vector<Tick> m_vTicks;
+	std::vector<Object> m_vObjects;
+	std::vector<std::string> m_vsTypeNames;
+};
+
+#endif
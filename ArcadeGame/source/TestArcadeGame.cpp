@@ -1,51 +1,1034 @@
 #include "ArcadeGame.h"
+#include "SoftwareRenderer.h"
+#include "RenderThread.h"
+#include "InputQueue.h"
+#include "ReplayFile.h"
+#include "LookaheadBot.h"
+#include "StateHashLog.h"
+#include "SessionPool.h"
+#include "BatchEnv.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <algorithm>
+#include <memory>
+#include <atomic>
 
-int main ()
+/* The time available for each tick, at the 30 ticks per second BaseArcade runs at. */
+static const sf::Int64 s_kiFRAME_BUDGET = 1000000 / 30;
+
+/* While the game is idle only one tick in this many is drawn, which is enough to keep the background moving. */
+static const int s_kiIDLE_DRAW_INTERVAL = 3;
+
+/* The longest a self-check plays a game for, in ticks. A game with no input is lost well within this. */
+static const int s_kiCHECK_MAX_TICKS = 30 * 60 * 20;
+
+/* Prints how busy each of the job system's threads has been. */
+void printJobStats(JobSystem& jobs)
 {
-	sf::RenderWindow app(sf::VideoMode(BaseArcade::SCREEN_WIDTH, BaseArcade::SCREEN_HEIGHT), "MyTestGame",sf::Style::Close);
-	app.setKeyRepeatEnabled(false);
+	for (int i = 0; i < jobs.getNumThreads(); i++)
+	{
+		std::cout << "Job thread " << i << ": " << 100 * jobs.getUtilization(i) << "% busy, " << jobs.getNumRangesRun(i)
+				  << " ranges run, " << jobs.getNumSteals(i) << " stolen" << std::endl;
+	}
+}
 
-	ArcadeGame game(app);
+/* Feeds the ticks of a recording to a game, reading the file a chunk at a time. */
+class ReplayPlayer
+{
+public:
+	ReplayPlayer(const ReplayFile& replay) : m_Replay(replay)
+	{
+		m_iChunk = -1;
+	}
 
-	while (app.isOpen())
+	/* Sets up the input and load level of a tick. Returns false if the tick could not be read. */
+	bool setUpTick(int iTick, ArcadeGame& game, InputState& input)
 	{
-		if (!game.startFrame())
-			continue;
+		int iChunk = m_Replay.findKeyframe(iTick);
+		if (iChunk != m_iChunk)
+		{
+			m_iChunk = m_Replay.readTicks(iChunk, m_vTicks) ? iChunk : -1;
+		}
+		unsigned int iIndex = static_cast<unsigned int>(iTick - m_Replay.getKeyframeTick(iChunk));
+		if (m_iChunk < 0 || iIndex >= m_vTicks.size())
+		{
+			return false;
+		}
+		input.setFrame(m_vTicks[iIndex].input);
+		game.setLoadLevel(static_cast<FrameGovernor::Level>(m_vTicks[iIndex].iLoadLevel));
+		return true;
+	}
+
+	/* Brings a newly created game to the start of a tick, by restoring the nearest keyframe before it and running */
+	/* the ticks from there. Chunks saved without a keyframe are skipped back over; the very start needs none. */
+	bool seek(int iTick, ArcadeGame& game, InputState& input)
+	{
+		int iKeyframe = m_Replay.findKeyframe(iTick);
+		while (iKeyframe > 0 && !m_Replay.hasKeyframeState(iKeyframe))
+		{
+			iKeyframe--;
+		}
+
+		if (m_Replay.hasKeyframeState(iKeyframe))
+		{
+			std::vector<char> vState;
+			if (!m_Replay.readKeyframe(iKeyframe, vState))
+			{
+				return false;
+			}
+			ByteReader in(&vState[0], vState.size());
+			if (!game.readState(in))
+			{
+				return false;
+			}
+		}
 
-		sf::Event Event;
+		for (int i = m_Replay.getKeyframeTick(iKeyframe); i < iTick; i++)
+		{
+			if (!setUpTick(i, game, input))
+			{
+				return false;
+			}
+			game.gameMain(input);
+		}
+		return true;
+	}
 
-		std::string sKeyPressed;
+private:
+	const ReplayFile& m_Replay;
+	int m_iChunk;
+	std::vector<InputLog::Tick> m_vTicks;
 
-		while (app.pollEvent(Event))
-		{			
-			if (Event.type == sf::Event::Closed)
-                app.close();
+	ReplayPlayer(const ReplayPlayer&);
+	ReplayPlayer& operator=(const ReplayPlayer&);
+};
 
-			if ((Event.type == sf::Event::KeyPressed))
+/* Lists the objects at one tick of a log that have no object with the same hash at the same tick of the other. */
+void printUnmatchedObjects(const StateHashLog& log, int iIndex, const StateHashLog& other, int iOtherIndex, const char* sWhere)
+{
+	const StateHashLog::Tick& tick = log.getTick(iIndex);
+	const StateHashLog::Tick& otherTick = other.getTick(iOtherIndex);
+	std::vector<bool> vbMatched(otherTick.iNumObjects, false);
+	for (int i = tick.iFirstObject; i < tick.iFirstObject + tick.iNumObjects; i++)
+	{
+		const StateHashLog::Object& object = log.getObject(i);
+		bool bFound = false;
+		for (int j = 0; j < otherTick.iNumObjects && !bFound; j++)
+		{
+			if (!vbMatched[j] && other.getObject(otherTick.iFirstObject + j).iHash == object.iHash)
 			{
-				switch (Event.key.code){
-					case sf::Keyboard::R: sKeyPressed = "R"; break;
-					case sf::Keyboard::A: sKeyPressed = "A"; break;
-					case sf::Keyboard::S: sKeyPressed = "S"; break;
-					case sf::Keyboard::W: sKeyPressed = "W"; break;
-					case sf::Keyboard::D: sKeyPressed = "D"; break;
-					case sf::Keyboard::Space: sKeyPressed = "SPACE"; break;
-					case sf::Keyboard::Left: sKeyPressed = "LEFT"; break;
-					case sf::Keyboard::Right: sKeyPressed = "RIGHT"; break;
-					case sf::Keyboard::Up: sKeyPressed = "UP"; break;
-					case sf::Keyboard::Down: sKeyPressed = "DOWN"; break;
+				vbMatched[j] = true;
+				bFound = true;
+			}
+		}
+		if (!bFound)
+		{
+			std::cout << "  " << sWhere << ": object " << i - tick.iFirstObject << ", " << log.getTypeNames()[object.iType]
+					  << " at (" << object.position.x << ", " << object.position.y << ")" << std::endl;
+		}
+	}
+}
+
+/* Compares the state hashes of a run with those of an earlier one, and reports the first tick they differ at */
+/* and which objects differ. Returns true if they differ. */
+bool compareHashLogs(const StateHashLog& hashes, const StateHashLog& golden)
+{
+	int iIndex;
+	int iGoldenIndex;
+	if (!StateHashLog::findDivergence(hashes, golden, iIndex, iGoldenIndex))
+	{
+		std::cout << "State hashes match" << std::endl;
+		return false;
+	}
+
+	std::cout << "State hashes first differ after tick " << hashes.getTick(iIndex).iTick << std::endl;
+	printUnmatchedObjects(hashes, iIndex, golden, iGoldenIndex, "only in this run");
+	printUnmatchedObjects(golden, iGoldenIndex, hashes, iIndex, "only in the earlier run");
+	return true;
+}
+
+/* Runs the game for a fixed number of ticks without a window, drawing every frame with the software renderer. */
+/* The game runs on a fixed timestep, so ticks are run as fast as they can be rather than 30 times a second. */
+/* If pReplay is given, its seed and input are used and iTicks is ignored, which plays back a recorded game. */
+/* The replay starts from iFromTick, which is reached from the nearest keyframe without drawing anything. */
+/* Frames can be saved to sCaptureDir and/or compared with previously saved frames in sGoldenDir. In the same */
+/* way, the state hash of every tick can be saved to sHashLogPath and/or compared with those in sHashGoldenPath. */
+/* Returns the number of frames that did not match their golden image, plus one if the state hashes did not */
+/* match, or -1 if the replay could not be read. A replay is played back with the arithmetic it was recorded with. */
+int runHeadless(int iTicks, sf::Uint64 iSeed, std::string sCaptureDir, std::string sGoldenDir, const ReplayFile* pReplay, int iFromTick,
+				std::string sHashLogPath, std::string sHashGoldenPath, bool bFixedPoint)
+{
+	if (pReplay != NULL)
+	{
+		iTicks = pReplay->getNumTicks();
+		iSeed = pReplay->getSeed();
+		bFixedPoint = pReplay->isFixedPoint();
+	}
+	iFromTick = std::max(0, std::min(iFromTick, iTicks));
+	if (iTicks == iFromTick)
+	{
+		return 0;
+	}
+
+	sf::RenderWindow app;
+	ArcadeGame game(app, iSeed, -1);
+	game.setFixedPoint(bFixedPoint);
+
+	SoftwareRenderer renderer(BaseArcade::SCREEN_WIDTH, BaseArcade::SCREEN_HEIGHT);
+	renderer.setColourKey(sf::Color::Black);
+	game.setRenderer(&renderer);
+
+	sf::Int64 iTotalRenderTime = 0;
+	double dTotalRedrawn = 0;
+	int iNumMismatches = 0;
+	int iTick = 0;
+	InputState input;
+
+	std::unique_ptr<ReplayPlayer> pPlayer;
+	if (pReplay != NULL)
+	{
+		pPlayer.reset(new ReplayPlayer(*pReplay));
+	}
+	if (pPlayer && iFromTick > 0)
+	{
+		sf::Clock seekClock;
+		if (!pPlayer->seek(iFromTick, game, input))
+		{
+			std::cout << "Could not read the recording up to tick " << iFromTick << std::endl;
+			return -1;
+		}
+		iTick = iFromTick;
+		std::cout << "Reached tick " << iTick << " in " << seekClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+	}
+
+	StateHashLog hashes;
+	bool bHashing = !sHashLogPath.empty() || !sHashGoldenPath.empty();
+	sf::Int64 iTotalHashTime = 0;
+	long long iTotalHashedObjects = 0;
+
+	int iNumTicks = iTicks - iTick;
+	sf::Clock runClock;
+	while (iTick < iTicks)
+	{
+		if (pPlayer && !pPlayer->setUpTick(iTick, game, input))
+		{
+			std::cout << "Could not read tick " << iTick << " of the recording" << std::endl;
+			return -1;
+		}
+
+		game.gameMain(input);
+		game.render();
+		iTick++;
+		if (bHashing)
+		{
+			sf::Clock hashClock;
+			hashes.addTick(iTick, game);
+			iTotalHashTime += hashClock.getElapsedTime().asMicroseconds();
+			iTotalHashedObjects += game.getObjectHashes().size();
+		}
+		iTotalRenderTime += renderer.getLastRenderTime();
+		for (unsigned int i = 0; i < renderer.getDirtyRects().size(); i++)
+		{
+			dTotalRedrawn += renderer.getDirtyRects()[i].width * renderer.getDirtyRects()[i].height;
+		}
+
+		std::ostringstream fileName;
+		fileName << "/frame_" << std::setw(5) << std::setfill('0') << iTick << ".png";
+
+		if (!sCaptureDir.empty())
+		{
+			renderer.saveFrame(sCaptureDir + fileName.str());
+		}
+		if (!sGoldenDir.empty())
+		{
+			int iDifferent = renderer.compareWithImage(sGoldenDir + fileName.str());
+			if (iDifferent != 0)
+			{
+				std::cout << "Frame " << iTick << ": " << (iDifferent < 0 ? "missing golden image" : "pixels differ: ");
+				if (iDifferent > 0)
+					std::cout << iDifferent;
+				std::cout << std::endl;
+				iNumMismatches++;
+			}
+		}
+	}
+
+	sf::Int64 iRunTime = std::max<sf::Int64>(runClock.getElapsedTime().asMicroseconds(), 1);
+	std::cout << "Ran " << iNumTicks << " ticks in " << iRunTime / 1000 << " ms, " << iNumTicks * 1000000LL / iRunTime
+			  << " ticks per second" << std::endl;
+	std::cout << "Rendered " << iNumTicks << " frames, average render time " << iTotalRenderTime / iNumTicks << " us, "
+			  << 100 * dTotalRedrawn / (static_cast<double>(iNumTicks) * BaseArcade::SCREEN_WIDTH * BaseArcade::SCREEN_HEIGHT)
+			  << "% of pixels redrawn" << std::endl;
+	if (bHashing)
+	{
+		std::cout << "Hashed " << iNumTicks << " ticks, average hash time " << iTotalHashTime / iNumTicks << " us for "
+				  << iTotalHashedObjects / iNumTicks << " objects" << std::endl;
+	}
+	if (!sGoldenDir.empty())
+	{
+		std::cout << iNumMismatches << " frames did not match" << std::endl;
+	}
+	if (!sHashLogPath.empty() && !hashes.save(sHashLogPath))
+	{
+		std::cout << "Could not write the state hashes to " << sHashLogPath << std::endl;
+	}
+	if (!sHashGoldenPath.empty())
+	{
+		StateHashLog golden;
+		if (!golden.load(sHashGoldenPath))
+		{
+			std::cout << "Could not read the state hashes in " << sHashGoldenPath << std::endl;
+			iNumMismatches++;
+		}
+		else if (compareHashLogs(hashes, golden))
+		{
+			iNumMismatches++;
+		}
+	}
+	printJobStats(game.getJobSystem());
+	return iNumMismatches;
+}
+
+/* Lets a LookaheadBot play the game without a window for a number of ticks, with its futures played out in a */
+/* second game. Whenever the bot loses, a new game is started straight away. Reports how the bot did, how fast */
+/* futures were forked and run, as a benchmark of the two, and how long restarting took. */
+void runBot(int iTicks, sf::Uint64 iSeed, int iNumRollouts, bool bFixedPoint)
+{
+	sf::RenderWindow app;
+	ArcadeGame game(app, iSeed, -1);
+	game.setFixedPoint(bFixedPoint);
+	ArcadeGame worker(app, iSeed, game.getAssets(), 0);
+	LookaheadBot bot(worker, iSeed);
+	bot.setSearch(iNumRollouts, 30);
+
+	InputState input;
+	int iNumGames = 1;
+	int iBestScore = 0;
+	sf::Int64 iTotalRestartTime = 0;
+	sf::Clock runClock;
+	for (int i = 0; i < iTicks; i++)
+	{
+		if (game.getGameState() == ArcadeGame::SCOREBOARD)
+		{
+			iBestScore = std::max(iBestScore, game.getScore());
+			game.restartGame();
+			iTotalRestartTime += game.getRestartTime();
+			iNumGames++;
+		}
+		bot.chooseInput(game, input);
+		game.gameMain(input);
+	}
+	sf::Int64 iRunTime = std::max<sf::Int64>(runClock.getElapsedTime().asMicroseconds(), 1);
+	sf::Int64 iNumFutures = std::max<sf::Int64>(bot.getNumRollouts(), 1);
+
+	std::cout << "Bot: " << iNumGames << " games in " << iRunTime / 1000 << " ms, best finished score " << iBestScore
+			  << ", last game score " << game.getScore() << " with " << game.getPlayerHealth() << " lives left" << std::endl;
+	if (iNumGames > 1)
+	{
+		std::cout << "Restart: average " << iTotalRestartTime / (iNumGames - 1) << " us" << std::endl;
+	}
+	std::cout << "Bot: " << bot.getNumRollouts() << " futures, " << bot.getNumRollouts() * 1000000 / iRunTime << " per second, "
+			  << bot.getNumTicksSimulated() * 1000000 / iRunTime << " ticks per second" << std::endl;
+	std::cout << "Bot: average " << bot.getForkTime() / iNumFutures << " us forking, " << bot.getSimulateTime() / iNumFutures
+			  << " us running each future" << std::endl;
+}
+
+/* Runs many games at once without a window, each with input of its own: firing all the time and moving up or */
+/* down for a second at a time, chosen at random. A game that ends is restarted straight away. Reports what */
+/* each game cost in memory and how many ticks were run per second across all of them. */
+void runSessions(int iTicks, sf::Uint64 iSeed, int iNumSessions, bool bFixedPoint)
+{
+	SessionPool pool;
+	sf::Clock createClock;
+	if (!pool.create(iNumSessions, iSeed))
+	{
+		std::cout << "Sessions: could not load every asset" << std::endl;
+	}
+	std::cout << "Sessions: " << iNumSessions << " created in " << createClock.getElapsedTime().asMilliseconds() << " ms, "
+			  << pool.getAssetMemory() / 1024 << " KB of shared assets, " << pool.getMemoryPerSession() / 1024
+			  << " KB per session" << std::endl;
+	pool.forEachSession([bFixedPoint](int, ArcadeGame& game)
+	{
+		game.setFixedPoint(bFixedPoint);
+	});
+
+	std::vector<InputState> vInputs(iNumSessions);
+	Random random(iSeed);
+	InputState::Frame frame;
+	frame.iPressed = 0;
+	frame.iReleased = 0;
+	std::atomic<int> iNumRestarts(0);
+	sf::Int64 iTotalStepTime = 0;
+	for (int i = 0; i < iTicks; i++)
+	{
+		pool.forEachSession([&iNumRestarts](int, ArcadeGame& game)
+		{
+			if (game.getGameState() == ArcadeGame::SCOREBOARD)
+			{
+				game.restartGame();
+				iNumRestarts++;
+			}
+		});
+
+		if (i % 30 == 0)
+		{
+			for (int j = 0; j < iNumSessions; j++)
+			{
+				frame.iHeld = static_cast<sf::Uint16>((1 << InputState::KEY_SPACE) | (1 << random.getInt(InputState::KEY_UP, InputState::KEY_DOWN)));
+				for (int k = 0; k < InputState::NUM_KEYS; k++)
+				{
+					frame.aiHeldFraction[k] = (frame.iHeld & (1 << k)) ? 255 : 0;
 				}
-			}	
+				vInputs[j].setFrame(frame);
+			}
 		}
 
-		game.gameMain(sKeyPressed);
-	
+		pool.step(&vInputs[0]);
+		iTotalStepTime += pool.getStepTime();
+	}
+
+	iTotalStepTime = std::max<sf::Int64>(iTotalStepTime, 1);
+	std::cout << "Sessions: " << static_cast<sf::Int64>(iTicks) * iNumSessions << " ticks in " << iTotalStepTime / 1000 << " ms, "
+			  << static_cast<sf::Int64>(iTicks) * iNumSessions * 1000000 / iTotalStepTime << " ticks per second on "
+			  << pool.getJobSystem().getNumThreads() << " threads, " << iNumRestarts << " games restarted" << std::endl;
+	printJobStats(pool.getJobSystem());
+}
+
+/* Steps a batch of games without a window, as a trainer would, with random keys held for a second at a time. */
+/* Reports the number of slot ticks run per second and how the games that ended did. */
+void runBatch(int iTicks, sf::Uint64 iSeed, int iNumSlots, bool bFixedPoint)
+{
+	BatchEnv env;
+	if (!env.create(iNumSlots, iSeed))
+	{
+		std::cout << "Batch: could not load every asset" << std::endl;
+	}
+	for (int i = 0; i < iNumSlots; i++)
+	{
+		env.getGame(i).setFixedPoint(bFixedPoint);
+	}
+
+	std::vector<sf::Uint16> viKeys(iNumSlots, 0);
+	Random random(iSeed);
+	int iNumEnded = 0;
+	sf::Int64 iTotalFinalScore = 0;
+	for (int i = 0; i < iTicks; i++)
+	{
+		if (i % 30 == 0)
+		{
+			for (int j = 0; j < iNumSlots; j++)
+			{
+				viKeys[j] = static_cast<sf::Uint16>(random.getInt(0, (1 << (InputState::KEY_SPACE + 1)) - 1));
+			}
+		}
+		env.step(&viKeys[0]);
+
+		const sf::Uint8* piResets = env.getResets();
+		for (int j = 0; j < iNumSlots; j++)
+		{
+			if (piResets[j])
+			{
+				iNumEnded++;
+				iTotalFinalScore += env.getFinalScores()[j];
+			}
+		}
+	}
+
+	std::cout << "Batch: " << env.getNumSteps() << " slot ticks, " << static_cast<sf::Int64>(env.getStepsPerSecond())
+			  << " per second, " << iNumEnded << " games ended";
+	if (iNumEnded > 0)
+	{
+		std::cout << " with an average score of " << iTotalFinalScore / iNumEnded;
+	}
+	std::cout << std::endl;
+}
+
+/* Plays a game headless with no input until the player has lost and the scoreboard is showing, drawing every */
+/* tick so that the text layer is brought up to date. Returns false if the scoreboard is never reached. */
+bool playToScoreboard(ArcadeGame& game, SoftwareRenderer& renderer)
+{
+	game.setRenderer(&renderer);
+	InputState input;
+	for (int i = 0; i < s_kiCHECK_MAX_TICKS; i++)
+	{
+		if (game.getGameState() == ArcadeGame::SCOREBOARD)
+		{
+			return true;
+		}
+		game.gameMain(input);
 		game.render();
+	}
+	return false;
+}
 
-		app.display();
+/* A game left on the scoreboard has nothing moving but its background, so it must report that it is idle. */
+bool checkScoreboardIdle()
+{
+	sf::RenderWindow app;
+	ArcadeGame game(app, 0);
+	SoftwareRenderer renderer(BaseArcade::SCREEN_WIDTH, BaseArcade::SCREEN_HEIGHT);
+	renderer.setColourKey(sf::Color::Black);
+	if (!playToScoreboard(game, renderer))
+	{
+		std::cout << "scoreboard-idle: the scoreboard was never reached" << std::endl;
+		return false;
+	}
+
+	InputState input;
+	for (int i = 0; i < 30; i++)
+	{
+		game.gameMain(input);
+		game.render();
+	}
+	if (!game.isIdle())
+	{
+		std::cout << "scoreboard-idle: a game left on the scoreboard is not idle" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/* Records commands from jobs forced onto every thread (a serial threshold and grain size of 1) and checks that */
+/* they merge into key order, with the commands for each key in the order they were recorded. The runs are */
+/* repeated until one has had part of its range run by a worker. Then a game whose updates are forced onto */
+/* workers the same way is played beside one that runs on a single thread, and their state hashes must match */
+/* on every tick, so objects are spawned and destroyed in the same order however the work is split. */
+bool checkCommandOrder()
+{
+	static const int s_kiNUM_ITEMS = 1000;
+	static const int s_kiMAX_RUNS = 100;
+
+	JobSystem jobs(3);
+	jobs.setSerialThreshold(1);
+	CommandBuffer commands;
+	commands.setNumThreads(jobs.getNumThreads());
+
+	/* Stand-ins for objects. Their addresses identify the commands and are never dereferenced. */
+	std::vector<char> vcObjects(s_kiNUM_ITEMS);
+	std::vector<int> viThreads(s_kiNUM_ITEMS);
+	bool bWorkerRan = false;
+	for (int iRun = 0; iRun < s_kiMAX_RUNS && !bWorkerRan; iRun++)
+	{
+		jobs.parallelForWithThreadIndex(0, s_kiNUM_ITEMS, 1, [&commands, &vcObjects, &viThreads](int iThread, int iBegin, int iEnd)
+		{
+			for (int i = iBegin; i < iEnd; i++)
+			{
+				GameObject* pObject = reinterpret_cast<GameObject*>(&vcObjects[i]);
+				commands.spawn(iThread, i, pObject);
+				commands.destroy(iThread, i, pObject);
+				viThreads[i] = iThread;
+			}
+		});
+
+		const std::vector<GameCommand>& vCommands = commands.merge();
+		if (static_cast<int>(vCommands.size()) != 2 * s_kiNUM_ITEMS)
+		{
+			std::cout << "command-order: " << vCommands.size() << " commands merged, not " << 2 * s_kiNUM_ITEMS << std::endl;
+			return false;
+		}
+		for (int i = 0; i < s_kiNUM_ITEMS; i++)
+		{
+			GameObject* pObject = reinterpret_cast<GameObject*>(&vcObjects[i]);
+			const GameCommand& spawn = vCommands[2 * i];
+			const GameCommand& destroy = vCommands[2 * i + 1];
+			if (spawn.type != GameCommand::SPAWN || spawn.iOrder != i || spawn.pObject != pObject ||
+				destroy.type != GameCommand::DESTROY || destroy.iOrder != i || destroy.pObject != pObject)
+			{
+				std::cout << "command-order: the commands for item " << i << " are out of order" << std::endl;
+				return false;
+			}
+			bWorkerRan = bWorkerRan || viThreads[i] != 0;
+		}
+	}
+	if (!bWorkerRan)
+	{
+		std::cout << "command-order: no range was ever run by a worker" << std::endl;
+		return false;
+	}
+
+	sf::RenderWindow app;
+	ArcadeGame serial(app, 0);
+	ArcadeGame parallel(app, 0, serial.getAssets(), 3);
+	parallel.getJobSystem().setSerialThreshold(1);
+	parallel.getJobSystem().setGrainSize(1);
+	InputState input;
+	for (int i = 0; i < s_kiCHECK_MAX_TICKS && serial.getGameState() != ArcadeGame::SCOREBOARD; i++)
+	{
+		serial.gameMain(input);
+		parallel.gameMain(input);
+		if (serial.hashState() != parallel.hashState())
+		{
+			std::cout << "command-order: a game split across threads differs from one that is not at tick " << i + 1 << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Draws the comet stage with no colour key, as the window does, and looks under each comet that is fully on */
+/* screen for a texel that is black in comet.png but not in the frame. That is the starfield showing through, */
+/* which it only does if the texture was loaded with its black made transparent. Texels next to one that is */
+/* not black are skipped, so that a comet drawn half a pixel out still lands on black. */
+bool checkCometColourKey()
+{
+	sf::Image comet;
+	if (!comet.loadFromFile("images/comet.png"))
+	{
+		std::cout << "comet-colour-key: images/comet.png could not be loaded" << std::endl;
+		return false;
+	}
+	int iWidth = static_cast<int>(comet.getSize().x);
+	int iHeight = static_cast<int>(comet.getSize().y);
+
+	sf::RenderWindow app;
+	ArcadeGame game(app, 0);
+	SoftwareRenderer renderer(BaseArcade::SCREEN_WIDTH, BaseArcade::SCREEN_HEIGHT);
+	game.setRenderer(&renderer);
+	InputState input;
+	bool bCometSeen = false;
+	for (int i = 0; i < s_kiCHECK_MAX_TICKS && game.getGameState() != ArcadeGame::SCOREBOARD; i++)
+	{
+		game.gameMain(input);
+		game.render();
+		game.hashState();
+
+		const sf::Uint8* pPixels = reinterpret_cast<const sf::Uint8*>(renderer.getPixels());
+		const std::vector<ArcadeGame::ObjectHash>& vObjects = game.getObjectHashes();
+		for (unsigned int j = 0; j < vObjects.size(); j++)
+		{
+			int iLeft = static_cast<int>(vObjects[j].position.x + 0.5f);
+			int iTop = static_cast<int>(vObjects[j].position.y + 0.5f);
+			if (std::string(vObjects[j].sType) != "comet" || iLeft < 0 || iTop < 0 ||
+				iLeft + iWidth > BaseArcade::SCREEN_WIDTH || iTop + iHeight > BaseArcade::SCREEN_HEIGHT)
+			{
+				continue;
+			}
+			bCometSeen = true;
+
+			for (int y = 1; y < iHeight - 1; y++)
+			{
+				for (int x = 1; x < iWidth - 1; x++)
+				{
+					bool bBlack = true;
+					for (int k = 0; k < 9 && bBlack; k++)
+					{
+						sf::Color texel = comet.getPixel(x + k % 3 - 1, y + k / 3 - 1);
+						bBlack = texel.r == 0 && texel.g == 0 && texel.b == 0;
+					}
+					const sf::Uint8* pPixel = pPixels + 4 * ((iTop + y) * BaseArcade::SCREEN_WIDTH + iLeft + x);
+					if (bBlack && (pPixel[0] != 0 || pPixel[1] != 0 || pPixel[2] != 0))
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	std::cout << "comet-colour-key: " << (bCometSeen ? "the starfield never showed through a comet's black"
+														: "no comet was ever fully on screen") << std::endl;
+	return false;
+}
+
+/* Runs the named self-check, or every one of them for "all". Prints each result and returns the number that failed. */
+int runChecks(const std::string& sName)
+{
+	static const char* s_kasNAMES[] = {"scoreboard-idle", "command-order", "comet-colour-key"};
+	static bool (*const s_kapCHECKS[])() = {checkScoreboardIdle, checkCommandOrder, checkCometColourKey};
+
+	int iNumRun = 0;
+	int iNumFailed = 0;
+	for (unsigned int i = 0; i < sizeof(s_kasNAMES) / sizeof(s_kasNAMES[0]); i++)
+	{
+		if (sName == "all" || sName == s_kasNAMES[i])
+		{
+			bool bPassed = s_kapCHECKS[i]();
+			std::cout << s_kasNAMES[i] << ": " << (bPassed ? "passed" : "FAILED") << std::endl;
+			iNumRun++;
+			iNumFailed += bPassed ? 0 : 1;
+		}
+	}
+	if (iNumRun == 0)
+	{
+		std::cout << "No check is called " << sName << std::endl;
+		return 1;
+	}
+	return iNumFailed;
+}
+
+/* Queues the window events the game is interested in, stamped with the time they arrived. */
+/* Returns false if the window has been asked to close. */
+bool queueEvent(const sf::Event& Event, InputQueue& inputs)
+{
+	switch (Event.type)
+	{
+	case sf::Event::Closed:
+		inputs.push(InputEvent::CLOSED);
+		return false;
+	case sf::Event::LostFocus:
+		inputs.push(InputEvent::LOST_FOCUS);
+		break;
+	case sf::Event::GainedFocus:
+		inputs.push(InputEvent::GAINED_FOCUS);
+		break;
+	case sf::Event::KeyPressed:
+	case sf::Event::KeyReleased:
+		{
+			InputState::Key key = InputState::fromKeyboard(Event.key.code);
+			if (key != InputState::NUM_KEYS)
+			{
+				inputs.push(Event.type == sf::Event::KeyPressed ? InputEvent::KEY_PRESSED : InputEvent::KEY_RELEASED, key);
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+/* Tracks whether the window has focus and records key presses and releases in the game's input state. */
+/* A minimized window loses focus, so this also covers minimizing. Keys are released on losing focus, */
+/* as their key up events will go to another window. */
+/* Returns false if the window has been asked to close. */
+bool handleEvent(const InputEvent& event, InputState& input, bool& bFocused)
+{
+	switch (event.type)
+	{
+	case InputEvent::CLOSED:
+		return false;
+	case InputEvent::LOST_FOCUS:
+		bFocused = false;
+		input.releaseAll(event.iTime);
+		break;
+	case InputEvent::GAINED_FOCUS:
+		bFocused = true;
+		break;
+	case InputEvent::KEY_PRESSED:
+		input.press(event.key, event.iTime);
+		break;
+	case InputEvent::KEY_RELEASED:
+		input.release(event.key, event.iTime);
+		break;
+	}
+	return true;
+}
+
+/* Timings gathered by the game thread, printed on exit. */
+class GameStats
+{
+public:
+	GameStats()
+	{
+		iTotalTickTime = 0;
+		iNumTicks = 0;
+		iTotalSaveTime = 0;
+		iTotalSimulateTime = 0;
+		iTotalRestoreTime = 0;
+		iNumRunAheadFrames = 0;
+	}
+
+	sf::Int64 iTotalTickTime;
+	int iNumTicks;
+	sf::Int64 iTotalSaveTime;
+	sf::Int64 iTotalSimulateTime;
+	sf::Int64 iTotalRestoreTime;
+	int iNumRunAheadFrames;
+};
+
+/* The game thread's main loop. Runs ticks until the window is closed, taking input from the queue. */
+/* Each frame carries the time of the oldest input it is the first to show, for the render thread's latency figures. */
+/* With iRunAheadTicks above 0, each frame shows the game that many ticks ahead of its real state. */
+/* The governor is given the longer of the game thread's and render thread's work each tick, as they run side */
+/* by side, and its level is passed on to the game. Every change of level is reported. */
+/* If pRecording is given, the input and load level of every tick are added to it, along with a keyframe of the */
+/* game's state whenever one is due. */
+void runGame(ArcadeGame& game, RenderThread& renderThread, InputQueue& inputs, int iRunAheadTicks, FrameGovernor& governor,
+			 GameStats& stats, InputLog* pRecording)
+{
+	bool bFocused = true;
+	bool bIdle = false;
+	bool bQuit = false;
+	InputState input;
+	input.newFrame(inputs.getTime());
+	sf::Int64 iOldestInputTime = -1;
+	sf::Clock tickClock;
+	std::vector<char> vKeyframe;
+
+	while (!bQuit)
+	{
+		/* Sleep rather than spin until the next frame is due. */
+		if (!game.startFrame())
+		{
+			sf::sleep(sf::milliseconds(1));
+			continue;
+		}
+
+		/* Nobody can see an unfocused or minimized window, so the game is paused until an event (usually */
+		/* regaining focus) arrives. */
+		if (!bFocused)
+		{
+			inputs.waitForEvent();
+		}
+
+		InputEvent event;
+		while (!bQuit && inputs.pop(event))
+		{
+			if (iOldestInputTime < 0)
+			{
+				iOldestInputTime = event.iTime;
+			}
+			bQuit = !handleEvent(event, input, bFocused);
+		}
+		if (bQuit)
+			break;
+
+		/* The tick covers the time since the last one, so keys held for part of it count for part of it. */
+		sf::Int64 iTickTime = inputs.getTime();
+		input.endFrame(iTickTime);
+		if (pRecording != NULL)
+		{
+			if (pRecording->isKeyframeDue())
+			{
+				vKeyframe.clear();
+				ByteWriter out(vKeyframe);
+				game.writeState(out);
+				pRecording->addKeyframe(vKeyframe);
+			}
+			pRecording->record(input, game.getLoadLevel());
+		}
+
+		tickClock.restart();
+		game.gameMain(input);
+		input.newFrame(iTickTime);
+
+		/* The tick that loses focus is not drawn, as nobody can see it. */
+		/* At the governor's last level, every other frame is not drawn either. While the game is idle only the */
+		/* background moves, so it is drawn at a reduced rate, unless input has arrived that should be shown. */
+		bool bHalfRate = game.getLoadLevel() >= FrameGovernor::HALF_RATE_RENDERING;
+		bool bSkipIdle = bIdle && iOldestInputTime < 0 && stats.iNumTicks % s_kiIDLE_DRAW_INTERVAL != 0;
+		if (bFocused && !(bHalfRate && stats.iNumTicks % 2 == 1) && !bSkipIdle)
+		{
+			if (iRunAheadTicks > 0)
+			{
+				game.buildRunAheadFrame(input, iRunAheadTicks, renderThread.getFrame());
+				stats.iTotalSaveTime += game.getRunAheadCost().iSaveTime;
+				stats.iTotalSimulateTime += game.getRunAheadCost().iSimulateTime;
+				stats.iTotalRestoreTime += game.getRunAheadCost().iRestoreTime;
+				stats.iNumRunAheadFrames++;
+			}
+			else
+			{
+				game.buildFrame(renderThread.getFrame());
+			}
+			renderThread.getFrame().iInputTime = iOldestInputTime;
+			renderThread.publish();
+			iOldestInputTime = -1;
+		}
+		else if (!bFocused)
+		{
+			iOldestInputTime = -1;
+		}
+		sf::Int64 iTickWork = tickClock.getElapsedTime().asMicroseconds();
+		stats.iTotalTickTime += iTickWork;
+		stats.iNumTicks++;
+
+		if (governor.addFrame(std::max(iTickWork, renderThread.getLastRenderTime())))
+		{
+			game.setLoadLevel(governor.getLevel());
+			std::cout << "Governor: average load " << governor.getAverageLoad() << " us of " << governor.getBudget()
+					  << " us, now at " << FrameGovernor::getLevelName(governor.getLevel()) << std::endl;
+		}
+
+		bIdle = game.isIdle();
 
 //		game.endFrame();
 	}
+}
+
+/* Command line: */
+/*	--headless <ticks>	run without a window for a number of ticks. Textures are still loaded, so an OpenGL context */
+/*						is still needed; on Linux that means an X display, e.g. from Xvfb. See SoftwareRenderer. */
+/*	--capture <dir>		with --headless, save every frame as a PNG file */
+/*	--golden <dir>		with --headless, compare every frame with the PNG files in a directory */
+/*	--run-ahead <ticks>	show the game a number of ticks ahead, to hide the latency of a tick */
+/*	--seed <n>			seed the game's random numbers. Headless runs use 0 by default, windowed games the time. */
+/*	--record <file>		save the seed and input of a windowed game to a file on exit */
+/*	--replay <file>		play back a recorded game headless, as fast as possible. Works with --capture and --golden. */
+/*	--from <tick>		with --replay, start from a tick, reached from the nearest keyframe before it */
+/*	--bot <futures>		with --headless, let a bot play, trying each action that many times a tick */
+/*	--hash-log <file>	with --headless or --replay, save the state hash of every tick to a file */
+/*	--hash-golden <file>	with --headless or --replay, compare the state hash of every tick with a saved --hash-log */
+/*	--fixed-point <0|1>	move objects in fixed point, so runs match across builds. Recordings remember the setting. */
+/*	--sessions <n>		with --headless, run that many games at once on a pool of threads */
+/*	--batch <slots>		with --headless, step that many games together through a BatchEnv */
+/*	--check <name>		run a headless self-check, or "all" of them, and exit with the number that failed */
+int main (int argc, char* argv[])
+{
+	int iHeadlessTicks = 0;
+	std::string sCaptureDir;
+	std::string sGoldenDir;
+	int iRunAheadTicks = 0;
+	bool bSeedGiven = false;
+	sf::Uint64 iSeed = 0;
+	std::string sRecordPath;
+	std::string sReplayPath;
+	int iFromTick = 0;
+	int iBotRollouts = 0;
+	std::string sHashLogPath;
+	std::string sHashGoldenPath;
+	bool bFixedPoint = false;
+	int iNumSessions = 0;
+	int iNumBatchSlots = 0;
+	std::string sCheckName;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+			iHeadlessTicks = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--capture") == 0)
+			sCaptureDir = argv[i + 1];
+		else if (strcmp(argv[i], "--golden") == 0)
+			sGoldenDir = argv[i + 1];
+		else if (strcmp(argv[i], "--run-ahead") == 0)
+			iRunAheadTicks = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0)
+		{
+			std::istringstream(argv[i + 1]) >> iSeed;
+			bSeedGiven = true;
+		}
+		else if (strcmp(argv[i], "--record") == 0)
+			sRecordPath = argv[i + 1];
+		else if (strcmp(argv[i], "--replay") == 0)
+			sReplayPath = argv[i + 1];
+		else if (strcmp(argv[i], "--from") == 0)
+			iFromTick = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--bot") == 0)
+			iBotRollouts = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--hash-log") == 0)
+			sHashLogPath = argv[i + 1];
+		else if (strcmp(argv[i], "--hash-golden") == 0)
+			sHashGoldenPath = argv[i + 1];
+		else if (strcmp(argv[i], "--fixed-point") == 0)
+			bFixedPoint = atoi(argv[i + 1]) != 0;
+		else if (strcmp(argv[i], "--sessions") == 0)
+			iNumSessions = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--batch") == 0)
+			iNumBatchSlots = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--check") == 0)
+			sCheckName = argv[i + 1];
+	}
+
+	if (!sCheckName.empty())
+	{
+		return runChecks(sCheckName);
+	}
+
+	if (!sReplayPath.empty())
+	{
+		ReplayFile replay;
+		if (!replay.open(sReplayPath))
+		{
+			std::cout << "Could not read the recording " << sReplayPath << std::endl;
+			return 1;
+		}
+		return runHeadless(0, 0, sCaptureDir, sGoldenDir, &replay, iFromTick, sHashLogPath, sHashGoldenPath, false) == 0 ? 0 : 1;
+	}
+	if (iHeadlessTicks > 0 && iNumBatchSlots > 0)
+	{
+		runBatch(iHeadlessTicks, iSeed, iNumBatchSlots, bFixedPoint);
+		return 0;
+	}
+	if (iHeadlessTicks > 0 && iNumSessions > 0)
+	{
+		runSessions(iHeadlessTicks, iSeed, iNumSessions, bFixedPoint);
+		return 0;
+	}
+	if (iHeadlessTicks > 0 && iBotRollouts > 0)
+	{
+		runBot(iHeadlessTicks, iSeed, iBotRollouts, bFixedPoint);
+		return 0;
+	}
+	if (iHeadlessTicks > 0)
+	{
+		return runHeadless(iHeadlessTicks, iSeed, sCaptureDir, sGoldenDir, NULL, 0, sHashLogPath, sHashGoldenPath, bFixedPoint) == 0 ? 0 : 1;
+	}
+	if (!bSeedGiven)
+	{
+		iSeed = static_cast<sf::Uint64>(time(NULL));
+	}
+
+	sf::RenderWindow app(sf::VideoMode(BaseArcade::SCREEN_WIDTH, BaseArcade::SCREEN_HEIGHT), "MyTestGame",sf::Style::Close);
+	app.setKeyRepeatEnabled(false);
+
+	ArcadeGame game(app, iSeed, -1);
+	game.setFixedPoint(bFixedPoint);
+
+	/* Frames are drawn and presented on a thread of their own, and the game runs on another. SFML only */
+	/* delivers a window's events to the thread that created it, so this thread is left to do nothing but */
+	/* wait for events and queue them, stamped with the time they arrived rather than the tick they are seen in. */
+	InputQueue inputs;
+	WindowRenderer renderer(app);
+	RenderThread renderThread(renderer, &app);
+	renderThread.setInputClock(&inputs.getClock());
+	renderThread.start();
+
+	GameStats stats;
+	InputLog recording;
+	recording.clear(iSeed);
+	recording.setFixedPoint(bFixedPoint);
+	FrameGovernor governor(s_kiFRAME_BUDGET);
+	std::thread gameThread([&]()
+	{
+		runGame(game, renderThread, inputs, iRunAheadTicks, governor, stats, sRecordPath.empty() ? NULL : &recording);
+	});
+
+	sf::Event Event;
+	bool bOpen = true;
+	while (bOpen && app.waitEvent(Event))
+	{
+		bOpen = queueEvent(Event, inputs);
+	}
+	if (bOpen)
+	{
+		inputs.push(InputEvent::CLOSED);
+	}
+	gameThread.join();
+
+	/* The render thread must let go of the window before it can be closed. */
+	renderThread.stop();
+	app.close();
+
+	std::cout << "Game: " << stats.iNumTicks << " ticks, average " << (stats.iNumTicks > 0 ? stats.iTotalTickTime / stats.iNumTicks : 0) << " us" << std::endl;
+	if (stats.iNumRunAheadFrames > 0)
+	{
+		std::cout << "Run-ahead: " << stats.iNumRunAheadFrames << " frames, average " << stats.iTotalSaveTime / stats.iNumRunAheadFrames
+				  << " us saving, " << stats.iTotalSimulateTime / stats.iNumRunAheadFrames << " us running ahead, "
+				  << stats.iTotalRestoreTime / stats.iNumRunAheadFrames << " us restoring" << std::endl;
+	}
+	std::cout << "Render: " << renderThread.getNumFramesRendered() << " frames (" << renderThread.getNumFramesDropped()
+			  << " dropped), average " << renderThread.getAverageRenderTime() << " us drawing, "
+			  << renderThread.getAveragePresentTime() << " us presenting" << std::endl;
+	std::cout << "Input latency: " << renderThread.getNumLatencySamples() << " samples, average "
+			  << renderThread.getAverageInputLatency() << " us, worst " << renderThread.getMaxInputLatency() << " us" << std::endl;
+	for (int i = 0; i < FrameGovernor::NUM_LEVELS; i++)
+	{
+		FrameGovernor::Level level = static_cast<FrameGovernor::Level>(i);
+		std::cout << "Governor: " << governor.getNumFramesAtLevel(level) << " frames at " << FrameGovernor::getLevelName(level) << std::endl;
+	}
+	printJobStats(game.getJobSystem());
+
+	if (!sRecordPath.empty())
+	{
+		if (ReplayFile::save(recording, sRecordPath))
+			std::cout << "Recorded " << recording.getNumTicks() << " ticks to " << sRecordPath << std::endl;
+		else
+			std::cout << "Could not write the recording " << sRecordPath << std::endl;
+	}
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,456 @@
+#include "TextLayer.h"
+#include <atomic>
+
+/* Shared by every layer, so that a state saved from one layer is never mistaken for another's text. */
+static std::atomic<unsigned int> s_iNextRevision(0);
+
+/* Constructor */
+TextLayer::TextLayer()
+{
+	m_bLayoutDirty = false;
+	m_bBatchDirty = false;
+	m_iRevision = 0;
+	m_pSharedAtlas = NULL;
+}
+
+/* Constructor */
+TextLayer::State::State()
+{
+	iRevision = 0;
+	bLayoutDirty = false;
+	bBatchDirty = false;
+}
+
+/* Loads the font shared by every text object in the layer and pre-rasterizes it. All existing text is laid out again. */
+bool TextLayer::loadFont(std::string sPath, const std::vector<unsigned int>& vSizes)
+{
+	if (!m_Atlas.build(sPath, vSizes))
+	{
+		return false;
+	}
+	for (unsigned int i = 0; i < m_vEntries.size(); i++)
+	{
+		m_vEntries[i].bDirty = true;
+	}
+	m_bLayoutDirty = true;
+	m_iRevision = 0;
+	return true;
+}
+
+/* All existing text is laid out again with the new atlas. */
+void TextLayer::setSharedAtlas(const GlyphAtlas* pAtlas)
+{
+	m_pSharedAtlas = pAtlas;
+	for (unsigned int i = 0; i < m_vEntries.size(); i++)
+	{
+		m_vEntries[i].bDirty = true;
+	}
+	m_bLayoutDirty = true;
+	m_iRevision = 0;
+}
+
+/* Creates a text object, reusing the slot of a removed one where possible. */
+TextLayer::TextHandle TextLayer::createText(std::string sString, int iXPos, int iYPos, unsigned int iSize, sf::Color colour)
+{
+	TextHandle handle;
+	if (!m_vFreeHandles.empty())
+	{
+		handle = m_vFreeHandles.back();
+		m_vFreeHandles.pop_back();
+	}
+	else
+	{
+		handle = static_cast<TextHandle>(m_vEntries.size());
+		m_vEntries.push_back(TextEntry());
+	}
+
+	TextEntry& entry = m_vEntries[handle];
+	entry.sString = sString;
+	entry.sSuffix.clear();
+	entry.iInteger = 0;
+	entry.bHasInteger = false;
+	entry.position = sf::Vector2f(static_cast<float>(iXPos), static_cast<float>(iYPos));
+	entry.iSize = iSize;
+	entry.colour = colour;
+	entry.bVisible = true;
+	entry.bInUse = true;
+	entry.vQuads.clear();
+	markDirty(handle);
+	return handle;
+}
+
+/* Removes a text object and frees its handle. */
+void TextLayer::removeText(TextHandle handle)
+{
+	if (isValid(handle))
+	{
+		m_vEntries[handle].bInUse = false;
+		m_vEntries[handle].vQuads.clear();
+		m_vFreeHandles.push_back(handle);
+		m_bBatchDirty = true;
+		m_iRevision = 0;
+	}
+}
+
+/* Removes every text object. */
+void TextLayer::clear()
+{
+	m_vEntries.clear();
+	m_vFreeHandles.clear();
+	m_pBatch.reset();
+	m_bLayoutDirty = false;
+	m_bBatchDirty = false;
+	m_iRevision = 0;
+}
+
+void TextLayer::setString(TextHandle handle, const std::string& sString)
+{
+	if (isValid(handle) && m_vEntries[handle].sString != sString)
+	{
+		m_vEntries[handle].sString = sString;
+		markDirty(handle);
+	}
+}
+
+void TextLayer::setInteger(TextHandle handle, int iValue)
+{
+	if (isValid(handle) && (!m_vEntries[handle].bHasInteger || m_vEntries[handle].iInteger != iValue))
+	{
+		m_vEntries[handle].iInteger = iValue;
+		m_vEntries[handle].bHasInteger = true;
+		markDirty(handle);
+	}
+}
+
+void TextLayer::setSuffix(TextHandle handle, const std::string& sSuffix)
+{
+	if (isValid(handle) && m_vEntries[handle].sSuffix != sSuffix)
+	{
+		m_vEntries[handle].sSuffix = sSuffix;
+		markDirty(handle);
+	}
+}
+
+void TextLayer::setPosition(TextHandle handle, int iXPos, int iYPos)
+{
+	sf::Vector2f position(static_cast<float>(iXPos), static_cast<float>(iYPos));
+	if (isValid(handle) && m_vEntries[handle].position != position)
+	{
+		m_vEntries[handle].position = position;
+		markDirty(handle);
+	}
+}
+
+void TextLayer::setCharacterSize(TextHandle handle, unsigned int iSize)
+{
+	if (isValid(handle) && m_vEntries[handle].iSize != iSize)
+	{
+		m_vEntries[handle].iSize = iSize;
+		markDirty(handle);
+	}
+}
+
+void TextLayer::setColour(TextHandle handle, sf::Color colour)
+{
+	if (isValid(handle) && m_vEntries[handle].colour != colour)
+	{
+		m_vEntries[handle].colour = colour;
+		markDirty(handle);
+	}
+}
+
+/* Hiding a text object only changes which quads go into the batch, so no layout is needed. */
+void TextLayer::setVisible(TextHandle handle, bool bVisible)
+{
+	if (isValid(handle) && m_vEntries[handle].bVisible != bVisible)
+	{
+		m_vEntries[handle].bVisible = bVisible;
+		m_bBatchDirty = true;
+		m_iRevision = 0;
+	}
+}
+
+/* Lays out the text objects that have changed since the last update and rebuilds the batch. */
+void TextLayer::update()
+{
+	if (m_bLayoutDirty || m_bBatchDirty)
+	{
+		m_iRevision = 0;
+	}
+
+	if (m_bLayoutDirty)
+	{
+		for (unsigned int i = 0; i < m_vEntries.size(); i++)
+		{
+			if (m_vEntries[i].bInUse && m_vEntries[i].bDirty)
+			{
+				layoutEntry(m_vEntries[i]);
+			}
+		}
+		m_bLayoutDirty = false;
+		m_bBatchDirty = true;
+	}
+
+	if (m_bBatchDirty)
+	{
+		rebuildBatch();
+		m_bBatchDirty = false;
+	}
+}
+
+bool TextLayer::hasChanges() const
+{
+	return m_bLayoutDirty || m_bBatchDirty;
+}
+
+const GlyphAtlas& TextLayer::getAtlas() const
+{
+	return m_pSharedAtlas ? *m_pSharedAtlas : m_Atlas;
+}
+
+/* Assigning into the state's lists reuses their memory, so saving every frame does not allocate once they have grown. */
+/* The batch is immutable and shared, so it is saved as it is rather than rebuilt on restore. */
+void TextLayer::saveState(State& state)
+{
+	if (m_iRevision == 0)
+	{
+		m_iRevision = ++s_iNextRevision;
+	}
+	if (state.iRevision == m_iRevision)
+	{
+		return;
+	}
+
+	state.iRevision = m_iRevision;
+	state.vEntries = m_vEntries;
+	state.vFreeHandles = m_vFreeHandles;
+	state.pBatch = m_pBatch;
+	state.bLayoutDirty = m_bLayoutDirty;
+	state.bBatchDirty = m_bBatchDirty;
+}
+
+void TextLayer::restoreState(const State& state)
+{
+	if (state.iRevision != 0 && state.iRevision == m_iRevision)
+	{
+		return;
+	}
+
+	m_iRevision = state.iRevision;
+	m_vEntries = state.vEntries;
+	m_vFreeHandles = state.vFreeHandles;
+	m_pBatch = state.pBatch;
+	m_bLayoutDirty = state.bLayoutDirty;
+	m_bBatchDirty = state.bBatchDirty;
+}
+
+/* Every entry is written, in use or not, so that handles still refer to the same text objects when read back. */
+void TextLayer::writeState(const State& state, ByteWriter& out)
+{
+	out.writeVarint(state.vEntries.size());
+	for (unsigned int i = 0; i < state.vEntries.size(); i++)
+	{
+		const TextEntry& entry = state.vEntries[i];
+		out.writeString(entry.sString);
+		out.writeString(entry.sSuffix);
+		out.writeInt32(entry.iInteger);
+		out.writeBool(entry.bHasInteger);
+		out.writeFloat(entry.position.x);
+		out.writeFloat(entry.position.y);
+		out.writeVarint(entry.iSize);
+		out.writeUint8(entry.colour.r);
+		out.writeUint8(entry.colour.g);
+		out.writeUint8(entry.colour.b);
+		out.writeUint8(entry.colour.a);
+		out.writeBool(entry.bVisible);
+		out.writeBool(entry.bInUse);
+	}
+	out.writeVarint(state.vFreeHandles.size());
+	for (unsigned int i = 0; i < state.vFreeHandles.size(); i++)
+	{
+		out.writeVarint(state.vFreeHandles[i]);
+	}
+}
+
+bool TextLayer::readState(ByteReader& in, State& state)
+{
+	state.iRevision = 0;
+	state.vEntries.clear();
+	state.vFreeHandles.clear();
+	state.pBatch.reset();
+	state.bLayoutDirty = true;
+	state.bBatchDirty = true;
+
+	sf::Uint64 iNumEntries = in.readVarint();
+	for (sf::Uint64 i = 0; i < iNumEntries && in.isValid(); i++)
+	{
+		TextEntry entry;
+		entry.sString = in.readString();
+		entry.sSuffix = in.readString();
+		entry.iInteger = in.readInt32();
+		entry.bHasInteger = in.readBool();
+		entry.position.x = in.readFloat();
+		entry.position.y = in.readFloat();
+		entry.iSize = static_cast<unsigned int>(in.readVarint());
+		entry.colour.r = in.readUint8();
+		entry.colour.g = in.readUint8();
+		entry.colour.b = in.readUint8();
+		entry.colour.a = in.readUint8();
+		entry.bVisible = in.readBool();
+		entry.bInUse = in.readBool();
+		entry.bDirty = true;
+		state.vEntries.push_back(entry);
+	}
+	sf::Uint64 iNumFreeHandles = in.readVarint();
+	for (sf::Uint64 i = 0; i < iNumFreeHandles && in.isValid(); i++)
+	{
+		TextHandle handle = static_cast<TextHandle>(in.readVarint());
+		if (handle < 0 || handle >= static_cast<TextHandle>(state.vEntries.size()))
+		{
+			break;
+		}
+		state.vFreeHandles.push_back(handle);
+	}
+
+	if (!in.isValid() || state.vFreeHandles.size() != iNumFreeHandles)
+	{
+		state.vEntries.clear();
+		state.vFreeHandles.clear();
+		return false;
+	}
+	return true;
+}
+
+/* Builds the glyph quads of a text object: the string, then the integer (if any), then the suffix. */
+/* This follows the layout rules of sf::Text so that text appears exactly where BaseArcade::createMessage() would have put it. */
+void TextLayer::layoutEntry(TextEntry& entry)
+{
+	entry.vQuads.clear();
+	entry.bDirty = false;
+
+	float x = entry.position.x;
+	float y = entry.position.y + static_cast<float>(entry.iSize);
+	sf::Uint32 iPrevCharacter = 0;
+
+	for (unsigned int i = 0; i < entry.sString.size(); i++)
+	{
+		layoutCharacter(entry, static_cast<unsigned char>(entry.sString[i]), x, y, iPrevCharacter);
+	}
+
+	if (entry.bHasInteger)
+	{
+		/* Digits are produced least significant first, so they are collected backwards in a small buffer. */
+		char acDigits[12];
+		int iNumDigits = 0;
+		unsigned int iMagnitude = entry.iInteger < 0 ? 0u - static_cast<unsigned int>(entry.iInteger) : static_cast<unsigned int>(entry.iInteger);
+		do
+		{
+			acDigits[iNumDigits++] = static_cast<char>('0' + iMagnitude % 10);
+			iMagnitude /= 10;
+		}
+		while (iMagnitude > 0);
+
+		if (entry.iInteger < 0)
+		{
+			layoutCharacter(entry, '-', x, y, iPrevCharacter);
+		}
+		while (iNumDigits > 0)
+		{
+			layoutCharacter(entry, acDigits[--iNumDigits], x, y, iPrevCharacter);
+		}
+	}
+
+	for (unsigned int i = 0; i < entry.sSuffix.size(); i++)
+	{
+		layoutCharacter(entry, static_cast<unsigned char>(entry.sSuffix[i]), x, y, iPrevCharacter);
+	}
+}
+
+/* Appends the quad for one character and advances the pen. Characters missing from the atlas are skipped. */
+void TextLayer::layoutCharacter(TextEntry& entry, sf::Uint32 iCharacter, float& x, float& y, sf::Uint32& iPrevCharacter)
+{
+	const GlyphAtlas& atlas = getAtlas();
+	x += static_cast<float>(atlas.getKerning(iPrevCharacter, iCharacter, entry.iSize));
+	iPrevCharacter = iCharacter;
+
+	switch (iCharacter)
+	{
+	case ' ':
+		x += static_cast<float>(atlas.getSpaceAdvance(entry.iSize));
+		return;
+	case '\t':
+		x += static_cast<float>(atlas.getSpaceAdvance(entry.iSize) * 4);
+		return;
+	case '\n':
+		y += static_cast<float>(atlas.getLineSpacing(entry.iSize));
+		x = entry.position.x;
+		return;
+	}
+
+	const GlyphAtlas::AtlasGlyph* pGlyph = atlas.getGlyph(iCharacter, entry.iSize);
+	if (!pGlyph)
+	{
+		return;
+	}
+
+	float fLeft = x + pGlyph->bounds.left;
+	float fTop = y + pGlyph->bounds.top;
+	float fRight = fLeft + pGlyph->bounds.width;
+	float fBottom = fTop + pGlyph->bounds.height;
+	float u1 = static_cast<float>(pGlyph->textureRect.left);
+	float v1 = static_cast<float>(pGlyph->textureRect.top);
+	float u2 = static_cast<float>(pGlyph->textureRect.left + pGlyph->textureRect.width);
+	float v2 = static_cast<float>(pGlyph->textureRect.top + pGlyph->textureRect.height);
+
+	entry.vQuads.push_back(sf::Vertex(sf::Vector2f(fLeft, fTop), entry.colour, sf::Vector2f(u1, v1)));
+	entry.vQuads.push_back(sf::Vertex(sf::Vector2f(fRight, fTop), entry.colour, sf::Vector2f(u2, v1)));
+	entry.vQuads.push_back(sf::Vertex(sf::Vector2f(fRight, fBottom), entry.colour, sf::Vector2f(u2, v2)));
+	entry.vQuads.push_back(sf::Vertex(sf::Vector2f(fLeft, fBottom), entry.colour, sf::Vector2f(u1, v2)));
+
+	x += pGlyph->advance;
+}
+
+/* Concatenates the cached quads of every visible text object into the single vertex list that is drawn. */
+/* A new list is made each time because frames already handed to a renderer may still refer to the old one. */
+void TextLayer::rebuildBatch()
+{
+	std::shared_ptr<std::vector<sf::Vertex> > pBatch(new std::vector<sf::Vertex>());
+	pBatch->reserve(m_pBatch ? m_pBatch->size() : 0);
+	for (unsigned int i = 0; i < m_vEntries.size(); i++)
+	{
+		const TextEntry& entry = m_vEntries[i];
+		if (entry.bInUse && entry.bVisible)
+		{
+			for (unsigned int j = 0; j < entry.vQuads.size(); j++)
+			{
+				pBatch->push_back(entry.vQuads[j]);
+			}
+		}
+	}
+	m_pBatch = pBatch;
+}
+
+/* Every glyph lives in the atlas texture, so the whole layer is one batch. */
+void TextLayer::appendTo(RenderFrame& frame) const
+{
+	if (m_pBatch && !m_pBatch->empty())
+	{
+		RenderBatch batch;
+		batch.pTexture = &getAtlas().getTexture();
+		batch.pVertices = m_pBatch;
+		batch.iKey = reinterpret_cast<std::size_t>(this);
+		frame.vOverlays.push_back(batch);
+	}
+}
+
+bool TextLayer::isValid(TextHandle handle) const
+{
+	return handle >= 0 && handle < static_cast<TextHandle>(m_vEntries.size()) && m_vEntries[handle].bInUse;
+}
+
+void TextLayer::markDirty(TextHandle handle)
+{
+	m_vEntries[handle].bDirty = true;
+	m_bLayoutDirty = true;
+	m_iRevision = 0;
+}
@@ -0,0 +1,195 @@
+#ifndef TEXT_LAYER_H
+#define TEXT_LAYER_H
+
+#include "SFML/Graphics.hpp"
+#include "GlyphAtlas.h"
+#include "RenderFrame.h"
+#include "ByteStream.h"
+#include <string>
+#include <vector>
+
+//! The TextLayer class
+
+/*!
+Retained-mode text. Unlike BaseArcade::createMessage(), which has to be called every frame,
+a text object is created once and is then referred to by its handle. The glyph quads of a text
+object are only laid out again when its string, number, size, colour or position changes. Glyphs
+come from a GlyphAtlas built while loading, so all visible text is drawn as a single batch.
+*/
+class TextLayer
+{
+public:
+	//! A handle to a text object, as returned by createText().
+	typedef int TextHandle;
+
+	//! The handle returned by createText() when no text object could be created.
+	static const TextHandle INVALID_HANDLE = -1;
+
+	//! TextLayer constructor.
+	TextLayer();
+
+	//! Load the font used by all text objects in the layer and build its glyph atlas.
+	/*!
+	Only the sizes given here can be used by text objects.
+	\param sPath the path and filename of the font.
+	\param vSizes the font sizes that will be used.
+	\return true if the font was loaded.
+	*/
+	bool loadFont(std::string sPath, const std::vector<unsigned int>& vSizes);
+
+	//! Use a glyph atlas built elsewhere instead of loading a font, e.g. one shared by many layers.
+	/*!
+	The atlas is only read, so layers on different threads can share it. It must outlive the layer.
+	\param pAtlas the atlas, or NULL to go back to the font given to loadFont().
+	*/
+	void setSharedAtlas(const GlyphAtlas* pAtlas);
+
+	//! Create a text object.
+	/*!
+	\param sString the string to appear on the screen.
+	\param iXPos the x-coordinate of the text.
+	\param iYPos the y-coordinate of the text.
+	\param iSize the font size. This must be one of the sizes given to loadFont().
+	\param colour the font colour. The default is white.
+	\return the handle of the new text object.
+	*/
+	TextHandle createText(std::string sString, int iXPos, int iYPos, unsigned int iSize, sf::Color colour = sf::Color::White);
+
+	//! Remove a text object. The handle may be reused by a later call to createText().
+	void removeText(TextHandle handle);
+
+	//! Remove all text objects.
+	void clear();
+
+	//! Change the string of a text object. Nothing is laid out again if the string is unchanged.
+	void setString(TextHandle handle, const std::string& sString);
+
+	//! Display an integer after the string of a text object.
+	/*!
+	The digits are laid out straight from the atlas without converting the number to a string first,
+	which makes this the cheapest way to display a score that changes often.
+	\param iValue the number to display.
+	*/
+	void setInteger(TextHandle handle, int iValue);
+
+	//! Set the string displayed after the integer of a text object.
+	void setSuffix(TextHandle handle, const std::string& sSuffix);
+
+	//! Move a text object.
+	void setPosition(TextHandle handle, int iXPos, int iYPos);
+
+	//! Change the font size of a text object.
+	void setCharacterSize(TextHandle handle, unsigned int iSize);
+
+	//! Change the colour of a text object.
+	void setColour(TextHandle handle, sf::Color colour);
+
+	//! Show or hide a text object. Hidden text objects keep their layout.
+	/*!
+	\param bVisible set to false to hide the text object. The default value is true.
+	*/
+	void setVisible(TextHandle handle, bool bVisible = true);
+
+	//! Lay out any text objects that have changed and rebuild the draw batch if necessary.
+	/*!
+	This should be called once per frame before the layer is drawn.
+	*/
+	void update();
+
+	//! Check whether any text object has changed since the last update().
+	bool hasChanges() const;
+
+	//! Add the layer's batch to a frame.
+	/*!
+	The batch is shared, not copied. It is replaced rather than modified when the text changes, so
+	frames that still hold the old one are unaffected.
+	*/
+	void appendTo(RenderFrame& frame) const;
+
+	//! Get the glyph atlas used by the layer.
+	const GlyphAtlas& getAtlas() const;
+
+	//! A copy of the layer's text objects, as taken by saveState().
+	class State;
+
+	//! Copy the layer's text objects, laid out or not, so that they can be put back with restoreState().
+	/*!
+	Nothing is copied if the state already holds the text as it is now, which is usually the case when the
+	same state is saved into every frame.
+	*/
+	void saveState(State& state);
+
+	//! Put back the text objects copied by saveState(). Handles refer to the same text objects as when the state was saved.
+	/*!
+	Nothing is copied if the layer's text has not changed since the state was saved or last restored.
+	*/
+	void restoreState(const State& state);
+
+	//! Write a state to a stream, e.g. to save it to a file.
+	/*!
+	Only what the text says and where it goes is written. Text read back with readState() is laid out again
+	by the next update().
+	*/
+	static void writeState(const State& state, ByteWriter& out);
+
+	//! Read a state written by writeState().
+	/*!
+	\return true if the state was read. If not, the state is left empty.
+	*/
+	static bool readState(ByteReader& in, State& state);
+
+private:
+	class TextEntry
+	{
+	public:
+		std::string sString;
+		std::string sSuffix;
+		int iInteger;
+		bool bHasInteger;
+		sf::Vector2f position;
+		unsigned int iSize;
+		sf::Color colour;
+		bool bVisible;
+		bool bInUse;
+		bool bDirty;
+		std::vector<sf::Vertex> vQuads;
+	};
+
+	void layoutEntry(TextEntry& entry);
+	void layoutCharacter(TextEntry& entry, sf::Uint32 iCharacter, float& x, float& y, sf::Uint32& iPrevCharacter);
+	void rebuildBatch();
+	bool isValid(TextHandle handle) const;
+	void markDirty(TextHandle handle);
+
+	GlyphAtlas m_Atlas;
+	/* Used instead of m_Atlas if not NULL. */
+	const GlyphAtlas* m_pSharedAtlas;
+	std::vector<TextEntry> m_vEntries;
+	std::vector<TextHandle> m_vFreeHandles;
+	std::shared_ptr<const std::vector<sf::Vertex> > m_pBatch;
+	bool m_bLayoutDirty;
+	bool m_bBatchDirty;
+	/* Identifies the text as it is now, so that saving and restoring can tell when there is nothing to copy. */
+	/* Every version of the text in any layer gets a different number; 0 means the text has changed since */
+	/* it was last given one. */
+	unsigned int m_iRevision;
+};
+
+class TextLayer::State
+{
+public:
+	State();
+
+private:
+	friend class TextLayer;
+
+	unsigned int iRevision;
+
+	std::vector<TextEntry> vEntries;
+	std::vector<TextHandle> vFreeHandles;
+	std::shared_ptr<const std::vector<sf::Vertex> > pBatch;
+	bool bLayoutDirty;
+	bool bBatchDirty;
+};
+
+#endif
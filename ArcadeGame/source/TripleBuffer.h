@@ -0,0 +1,90 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+//! The TripleBuffer class
+
+/*!
+Hands values from one producer thread to one consumer thread without either ever waiting for the other.
+The producer fills in the write buffer and publishes it. The consumer acquires the most recently published
+buffer and reads it for as long as it likes. If the producer publishes several times before the consumer
+acquires, only the latest value is seen (latest wins).
+
+The buffers are reused, so a value that owns memory (such as a RenderFrame) stops allocating once every
+buffer has grown to the size it needs.
+*/
+template <class T>
+class TripleBuffer
+{
+public:
+	//! TripleBuffer constructor.
+	TripleBuffer()
+	{
+		m_iWrite = 0;
+		m_iRead = 1;
+		m_iMiddle = 2;
+	}
+
+	//! Get the buffer the producer should fill in. Only the producer thread may call this.
+	T& getWriteBuffer()
+	{
+		return m_aBuffers[m_iWrite];
+	}
+
+	//! Publish the write buffer, replacing any value the consumer has not yet acquired.
+	/*!
+	Only the producer thread may call this.
+	\return true if a published value was replaced before the consumer acquired it.
+	*/
+	bool publish()
+	{
+		int iPrevious = m_iMiddle.exchange(m_iWrite | s_kiFRESH);
+		m_iWrite = iPrevious & s_kiINDEX_MASK;
+		return (iPrevious & s_kiFRESH) != 0;
+	}
+
+	//! Check whether the last value published has not yet been acquired, i.e. whether publishing now would replace it.
+	/*!
+	The consumer may acquire the value at any moment, so the answer can be out of date by the time it is used.
+	*/
+	bool isPending() const
+	{
+		return (m_iMiddle.load() & s_kiFRESH) != 0;
+	}
+
+	//! Take the most recently published value, if there is a new one. Only the consumer thread may call this.
+	/*!
+	\return true if a new value was acquired. If not, getReadBuffer() still holds the previous one.
+	*/
+	bool acquire()
+	{
+		if ((m_iMiddle.load() & s_kiFRESH) == 0)
+		{
+			return false;
+		}
+		m_iRead = m_iMiddle.exchange(m_iRead) & s_kiINDEX_MASK;
+		return true;
+	}
+
+	//! Get the buffer acquired by the consumer. Only the consumer thread may call this.
+	const T& getReadBuffer() const
+	{
+		return m_aBuffers[m_iRead];
+	}
+
+private:
+	static const int s_kiINDEX_MASK = 3;
+	static const int s_kiFRESH = 4;
+
+	T m_aBuffers[3];
+	int m_iWrite;
+	int m_iRead;
+	/* The index of the buffer that is in neither hand, plus a flag saying whether it has been published since it was last acquired. */
+	std::atomic<int> m_iMiddle;
+
+	TripleBuffer(const TripleBuffer&);
+	TripleBuffer& operator=(const TripleBuffer&);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "WindowRenderer.h"
+
+/* Appends a RenderQuad to a vertex array as four vertices. */
+static void appendQuad(sf::VertexArray& vertices, const RenderQuad& quad)
+{
+	float fRight = quad.dest.left + quad.dest.width;
+	float fBottom = quad.dest.top + quad.dest.height;
+	float u2 = quad.source.left + quad.source.width;
+	float v2 = quad.source.top + quad.source.height;
+	vertices.append(sf::Vertex(sf::Vector2f(quad.dest.left, quad.dest.top), quad.colour, sf::Vector2f(quad.source.left, quad.source.top)));
+	vertices.append(sf::Vertex(sf::Vector2f(fRight, quad.dest.top), quad.colour, sf::Vector2f(u2, quad.source.top)));
+	vertices.append(sf::Vertex(sf::Vector2f(fRight, fBottom), quad.colour, sf::Vector2f(u2, v2)));
+	vertices.append(sf::Vertex(sf::Vector2f(quad.dest.left, fBottom), quad.colour, sf::Vector2f(quad.source.left, v2)));
+}
+
+/* Constructor */
+WindowRenderer::WindowRenderer(sf::RenderTarget& target):m_Target(target)
+{
+	m_SpriteBatch.setPrimitiveType(sf::Quads);
+	m_pBatchTexture = NULL;
+}
+
+/* Draws the background layers one at a time, the sprites in as few batches as possible, then the overlays. */
+void WindowRenderer::renderFrame(const RenderFrame& frame)
+{
+	m_Target.clear(sf::Color(0, 0, 0, 255));
+
+	for (unsigned int i = 0; i < frame.vBackground.size(); i++)
+	{
+		m_SpriteBatch.clear();
+		appendQuad(m_SpriteBatch, frame.vBackground[i]);
+		m_Target.draw(m_SpriteBatch, sf::RenderStates(frame.vBackground[i].pTexture));
+	}
+
+	m_SpriteBatch.clear();
+	m_pBatchTexture = NULL;
+	for (unsigned int i = 0; i < frame.vSprites.size(); i++)
+	{
+		if (frame.vSprites[i].pTexture != m_pBatchTexture)
+		{
+			flushSprites();
+			m_pBatchTexture = frame.vSprites[i].pTexture;
+		}
+		appendQuad(m_SpriteBatch, frame.vSprites[i]);
+	}
+	flushSprites();
+
+	for (unsigned int i = 0; i < frame.vOverlays.size(); i++)
+	{
+		const RenderBatch& batch = frame.vOverlays[i];
+		if (batch.pVertices && !batch.pVertices->empty())
+		{
+			m_Target.draw(&(*batch.pVertices)[0], batch.pVertices->size(), sf::Quads, sf::RenderStates(batch.pTexture));
+		}
+	}
+}
+
+void WindowRenderer::flushSprites()
+{
+	if (m_SpriteBatch.getVertexCount() > 0)
+	{
+		m_Target.draw(m_SpriteBatch, sf::RenderStates(m_pBatchTexture));
+		m_SpriteBatch.clear();
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef WINDOW_RENDERER_H
+#define WINDOW_RENDERER_H
+
+#include "RenderFrame.h"
+
+//! The WindowRenderer class
+
+/*!
+Draws frames with the graphics card through SFML. Consecutive sprites that share a texture are
+merged into one draw call.
+*/
+class WindowRenderer : public Renderer
+{
+public:
+	//! WindowRenderer constructor.
+	/*!
+	\param target the window (or other render target) to draw to.
+	*/
+	WindowRenderer(sf::RenderTarget& target);
+
+	void renderFrame(const RenderFrame& frame);
+
+private:
+	void flushSprites();
+
+	sf::RenderTarget& m_Target;
+	sf::VertexArray m_SpriteBatch;
+	const sf::Texture* m_pBatchTexture;
+
+	WindowRenderer& operator=(const WindowRenderer&);
+};
+
+#endif